@@ -0,0 +1,182 @@
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <random>
+
+#include <zstd.h>
+
+#include "csv_reader.h"
+
+// Throughput comparison of the csv readers on a synthetic medooze.csv
+//
+// Usage : csv_bench [rows] [medooze.csv]
+// When a file is given it is used as is, otherwise one is generated in the
+// temporary directory. A generated file is also read back from zstd copies,
+// and the run fails if their columns differ.
+
+namespace
+{
+
+fs::path generate_medooze(size_t rows)
+{
+    fs::path p = fs::temp_directory_path() / "csv_bench_medooze.csv";
+
+    std::ofstream ofs(p);
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> size(100, 1200);
+
+    int sent_time = 0;
+    for(size_t i = 0; i < rows; ++i) {
+        sent_time += 150;
+
+        ofs << i / 10 << '|' << i << '|' << i / 10 << '|' << size(gen) << '|' << sent_time << '|'
+            << sent_time + 20000 << '|' << 150 << '|' << 148 << '|' << -2 << '|' << 2500000 << '|'
+            << 2400000 << '|' << 2600000 << '|' << 40 << '|' << 38 << '|' << 0 << '|' << (i % 50 == 0) << '|'
+            << (i % 97 == 0) << '\n';
+    }
+
+    return p;
+}
+
+void report(const char* name, const fs::path& p, std::chrono::steady_clock::time_point start, size_t rows, int64_t checksum)
+{
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double mb = fs::file_size(p) / (1024. * 1024.);
+
+    std::cout << name << " : " << rows << " rows in " << elapsed.count() << " s, "
+              << mb / elapsed.count() << " MB/s (checksum " << checksum << ")" << std::endl;
+}
+
+void run_scan(const fs::path& p)
+{
+    MappedFile file(p);
+
+    auto start = std::chrono::steady_clock::now();
+
+    size_t separators = 0;
+    csv_scan::SeparatorScanner scanner(file.data(), file.data() + file.size(), '|');
+    while(scanner.next() != file.data() + file.size()) ++separators;
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double mb = file.size() / (1024. * 1024.);
+
+    std::cout << "scan (" << csv_scan::kernel_name() << ") : " << separators << " separators in "
+              << elapsed.count() << " s, " << mb / elapsed.count() << " MB/s" << std::endl;
+}
+
+template<typename Reader>
+void run(const char* name, const fs::path& p)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    size_t rows = 0;
+    int64_t checksum = 0;
+    for(auto& it : Reader(p)) {
+        checksum += std::get<3>(it) + std::get<4>(it);
+        ++rows;
+    }
+
+    report(name, p, start, rows, checksum);
+}
+
+template<typename Reader>
+void run_parallel(const char* name, const fs::path& p)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    const auto columns = Reader(p).read_columns_parallel();
+    const auto& packet_size = std::get<3>(columns);
+    const auto& sent_time = std::get<4>(columns);
+
+    int64_t checksum = 0;
+    for(size_t i = 0; i < sent_time.size(); ++i) checksum += packet_size[i] + sent_time[i];
+
+    report(name, p, start, sent_time.size(), checksum);
+}
+
+// Copy of src compressed in the given number of zstd frames
+fs::path write_zstd(const fs::path& src, const fs::path& dst, size_t frames)
+{
+    std::ifstream ifs(src, std::ios::binary);
+    std::string content{ std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>() };
+
+    std::ofstream ofs(dst, std::ios::binary);
+    size_t frame_size = content.size() / frames + 1;
+
+    for(size_t pos = 0; pos < content.size(); pos += frame_size) {
+        size_t n = std::min(frame_size, content.size() - pos);
+
+        std::string frame(ZSTD_compressBound(n), '\0');
+        size_t size = ZSTD_compress(frame.data(), frame.size(), content.data() + pos, n, 1);
+        if(ZSTD_isError(size)) throw std::runtime_error(ZSTD_getErrorName(size));
+
+        ofs.write(frame.data(), static_cast<std::streamsize>(size));
+    }
+
+    return dst;
+}
+
+// Columns of p read back from zstd copies of it: a single line, a single
+// frame and several frames. A truncated copy must throw.
+bool check_zstd(const fs::path& p)
+{
+    using Reader = CsvReaderTypeRepeat<'|', int, 17>;
+
+    fs::path dir = fs::temp_directory_path();
+    bool ok = true;
+
+    auto expect = [&ok](bool cond, const char* what) {
+        if(!cond) std::cout << "zstd round trip : " << what << " failed" << std::endl;
+        ok = ok && cond;
+    };
+
+    {
+        fs::path line = dir / "csv_bench_line.csv";
+        std::ofstream(line) << "1|2|3|4|5|6|7|8|9|10|11|12|13|14|15|16|17\n";
+
+        auto columns = Reader(write_zstd(line, dir / "csv_bench_line.csv.zst", 1)).read_columns();
+        expect(std::get<0>(columns) == std::vector<int>{ 1 } && std::get<16>(columns) == std::vector<int>{ 17 }, "single line");
+    }
+
+    const auto plain = Reader(p).read_columns();
+
+    for(size_t frames : { 1, 7 }) {
+        fs::path zst = write_zstd(p, dir / "csv_bench_medooze.csv.zst", frames);
+
+        expect(Reader(zst).read_columns() == plain, "read_columns");
+        expect(Reader(zst).read_columns_parallel() == plain, "read_columns_parallel");
+    }
+
+    fs::path truncated = dir / "csv_bench_truncated.csv.zst";
+    fs::copy_file(dir / "csv_bench_medooze.csv.zst", truncated, fs::copy_options::overwrite_existing);
+    fs::resize_file(truncated, fs::file_size(truncated) / 2);
+
+    bool thrown = false;
+    try {
+        Reader(truncated).read_columns();
+    }
+    catch(const std::runtime_error&) {
+        thrown = true;
+    }
+    expect(thrown, "truncated stream");
+
+    if(ok) std::cout << "zstd round trip : ok" << std::endl;
+    return ok;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    size_t rows = argc > 1 ? std::stoul(argv[1]) : 2000000;
+    fs::path p = argc > 2 ? fs::path(argv[2]) : generate_medooze(rows);
+
+    run<StreamCsvReaderTypeRepeat<'|', int, 17>>("stream", p);
+    run<CsvReaderTypeRepeat<'|', int, 17>>("mapped", p);
+    run_parallel<CsvReaderTypeRepeat<'|', int, 17>>("parallel", p);
+    run_scan(p);
+
+    if(argc <= 2 && !check_zstd(p)) return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
@@ -21,7 +21,7 @@ AllBitrateDisplay::AllBitrateDisplay(QWidget* tab, QVBoxLayout* layout, QListWid
 AllBitrateDisplay::~AllBitrateDisplay()
 {}
 
-void AllBitrateDisplay::init_map(StatMap& map, bool signal)
+void AllBitrateDisplay::init_map(Experiment& exp)
 {}
 
 void AllBitrateDisplay::create_legend(const fs::path& p, bool signal)
@@ -30,8 +30,10 @@ void AllBitrateDisplay::create_legend(const fs::path& p, bool signal)
         connect(_legend, &QListWidget::itemChanged, this, [this, p](QListWidgetItem* item) -> void {
             StatKey key = static_cast<StatKey>(item->data(1).toUInt());
 
-            auto& map = _path_keys[p.c_str()];
-            auto line = std::get<StatsKeyProperty::SERIE>(map[key]);
+            auto exp = find_experiment(p);
+            if(!exp) return;
+
+            auto line = (*exp)[key].serie;
             if(line == nullptr) return;
 
             if(item->checkState()) line->show();
@@ -39,77 +41,70 @@ void AllBitrateDisplay::create_legend(const fs::path& p, bool signal)
         });
     }
 
-    auto& map = _path_keys[p.c_str()];
-    for(auto it = map.cbegin(); it != map.cend(); ++it) {
+    auto exp = find_experiment(p);
+    if(!exp) return;
+
+    exp->for_each([this](uint8_t key, const Slot& slot) {
         QListWidgetItem * item = new QListWidgetItem(_legend);
         item->setFlags(Qt::ItemIsUserCheckable | Qt::ItemIsEnabled);
         item->setCheckState(Qt::Checked);
-        item->setText(std::get<StatsKeyProperty::NAME>(it.value()));
-        item->setData(1, static_cast<uint8_t>(it.key()));
-    }
+        item->setText(slot.name);
+        item->setData(1, key);
+    });
 }
 
-void AllBitrateDisplay::add_stats(const fs::path& path, StatKey key, std::tuple<QString, QAbstractSeries*, QChart*, ExpInfo, bool> s)
+void AllBitrateDisplay::add_stats(const fs::path& path, StatKey key, const Slot& s)
 {
-    auto& map = _path_keys[path.c_str()];
-    map[key] = s;
-
-    // qInfo() << "Numa : " << std::get<StatsKeyProperty::NAME>(s);
-
-    std::get<StatsKeyProperty::CHART>(map[key]) = _chart;
+    auto exp = experiment(path);
 
-    auto info = std::get<StatsKeyProperty::INFO>(s);
-    info.stream = false; // continuous line
-    info.color = colors[current_color++];
+    auto& slot = (*exp)[key];
+    slot = s;
 
-    std::get<StatsKeyProperty::INFO>(map[key]) = info;
+    slot.chart = _chart;
+    slot.info.stream = false; // continuous line
+    slot.info.color = colors[current_color++];
 
     if(key == QUIC_LOSS) {
-        std::get<StatsKeyProperty::NAME>(map[key]) = "Quic Loss";
+        slot.name = "Quic Loss";
     }
     else if(key == MEDOOZE_LOSS) {
-        std::get<StatsKeyProperty::NAME>(map[key]) = "Medooze Loss";
+        slot.name = "Medooze Loss";
     }
     else if(key == QUIC_RTT) {
-        std::get<StatsKeyProperty::NAME>(map[key]) = "Quic RTT";
+        slot.name = "Quic RTT";
     }
     else if(key == MEDOOZE_RTT) {
-        std::get<StatsKeyProperty::NAME>(map[key]) = "Medooze RTT";
+        slot.name = "Medooze RTT";
     }
     else if(key == TOTAL) {
-        std::get<StatsKeyProperty::NAME>(map[key]) = "Medooze sent";
-    }
-    else {
-        std::get<StatsKeyProperty::NAME>(map[key]) = std::get<StatsKeyProperty::NAME>(s);
+        slot.name = "Medooze sent";
     }
 
-    create_serie(path, key);
+    create_serie(exp, key);
 
-    auto old_serie = static_cast<QLineSeries*>(std::get<StatsKeyProperty::SERIE>(s));
+    auto old_serie = static_cast<QLineSeries*>(s.serie);
 
-    auto pts = old_serie->points();
+    // the whole serie, not its decimated view
+    auto pts = s.detail ? s.detail->points() : old_serie->points();
     int y_loss = 0;
-    for(auto pt : pts) {
+    for(auto& pt : pts) {
         // if(key == StatKey::CWND) pt.setY(pt.y() * 8. / 1000.);
         if(key == StatKey::QUIC_RTT) pt.setY(pt.y() / 1000.);
         /*if(key == StatKey::MEDOOZE_LOSS) {
             y_loss += pt.y();
             pt.setY(y_loss);
         }*/
-
-        add_point(path.c_str(), key, pt);
     }
+
+    set_points(exp, key, pts);
 }
 
 void AllBitrateDisplay::load(const fs::path& path)
 {
     create_legend(path);
 
-    auto& map =  _path_keys[path.c_str()];
-    const auto& keys = map.keys();
-
-    for(auto key : keys) {
-        add_serie(path.c_str(), key);
+    if(auto exp = find_experiment(path)) {
+        exp->for_each([this, exp](uint8_t key, const Slot&) { add_serie(exp, key); });
     }
 
     _chart->createDefaultAxes();
@@ -117,8 +112,8 @@ void AllBitrateDisplay::load(const fs::path& path)
     /*auto loss_axis = new QValueAxis();
     _chart->addAxis(loss_axis, Qt::AlignRight);
 
-    auto* quic_loss_serie = std::get<StatsKeyProperty::SERIE>(map[StatKey::QUIC_LOSS]);
-    auto* medooze_loss_serie = std::get<StatsKeyProperty::SERIE>(map[StatKey::MEDOOZE_LOSS]);
+    auto* quic_loss_serie = (*exp)[StatKey::QUIC_LOSS].serie;
+    auto* medooze_loss_serie = (*exp)[StatKey::MEDOOZE_LOSS].serie;
 
     const auto& quic_pts = quic_loss_serie->points();
     const auto& medooze_pts = medooze_loss_serie->points();
@@ -11,7 +11,7 @@ class AllBitrateDisplay : public QObject, public DisplayBase
     StatsLineChart * _chart;
     StatsLineChartView * _chart_view;
 
-    void init_map(StatMap& map, bool signal = true) override;
+    void init_map(Experiment& exp) override;
 
     static std::vector<QColor> colors;
     static int current_color;
@@ -64,10 +64,12 @@ public:
         NUM_KEY
     };
 
+    static_assert(StatKey::NUM_KEY <= MAX_KEYS);
+
     AllBitrateDisplay(QWidget* tab, QVBoxLayout* layout, QListWidget* legend, QTreeWidget* info);
     ~AllBitrateDisplay();
 
-    void add_stats(const fs::path&, StatKey key, std::tuple<QString, QAbstractSeries*, QChart*, ExpInfo, bool> s);
+    void add_stats(const fs::path&, StatKey key, const Slot& s);
 
     void create_legend(const fs::path& p, bool signal = true);
 
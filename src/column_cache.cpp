@@ -0,0 +1,213 @@
+#include "column_cache.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace column_cache
+{
+
+namespace
+{
+
+constexpr char MAGIC[8] = { 'S', 'V', 'C', 'O', 'L', 'S', '\0', '\0' };
+constexpr uint32_t VERSION = 1;
+constexpr size_t ALIGNMENT = 64;
+constexpr size_t FINGERPRINT_SIZE = 64 * 1024;
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t num_columns;
+    uint64_t schema;
+    uint64_t size;
+    int64_t mtime;
+    uint64_t fingerprint;
+};
+
+size_t align(size_t offset)
+{
+    return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+uint64_t fnv1a(uint64_t h, const char* data, size_t size)
+{
+    for(size_t i = 0; i < size; ++i) {
+        h ^= static_cast<uint8_t>(data[i]);
+        h *= 1099511628211ull;
+    }
+
+    return h;
+}
+
+}
+
+struct Entry
+{
+    uint64_t offset;
+    uint64_t count;
+    uint32_t type_size;
+    uint32_t padding;
+};
+
+Stamp stamp_of(const fs::path& source)
+{
+    Stamp stamp;
+
+    std::error_code ec;
+    stamp.size = fs::file_size(source, ec);
+    if(ec) return {};
+
+    stamp.mtime = fs::last_write_time(source, ec).time_since_epoch().count();
+
+    std::ifstream ifs(source, std::ios::binary);
+    std::vector<char> block(FINGERPRINT_SIZE);
+
+    uint64_t h = schema_id("");
+
+    ifs.read(block.data(), block.size());
+    h = fnv1a(h, block.data(), ifs.gcount());
+
+    if(stamp.size > 2 * FINGERPRINT_SIZE) {
+        ifs.clear();
+        ifs.seekg(stamp.size - FINGERPRINT_SIZE);
+        ifs.read(block.data(), block.size());
+        h = fnv1a(h, block.data(), ifs.gcount());
+    }
+
+    stamp.fingerprint = h;
+    return stamp;
+}
+
+fs::path cache_path(const fs::path& source)
+{
+    std::string name = "." + source.filename().string() + ".cols";
+
+    const char* dir = std::getenv("STATS_VIEWER_CACHE_DIR");
+    if(dir == nullptr || *dir == '\0') return source.parent_path() / name;
+
+    // flat cache directory, keyed on the absolute source path
+    std::error_code ec;
+    auto absolute = fs::absolute(source, ec).string();
+
+    std::ostringstream key;
+    key << std::hex << schema_id(absolute);
+
+    return fs::path(dir) / (key.str() + name);
+}
+
+bool Writer::write(const fs::path& cache, uint64_t schema, const Stamp& stamp) const
+{
+    std::error_code ec;
+    fs::create_directories(cache.parent_path(), ec);
+
+    std::ostringstream suffix;
+    suffix << ".tmp" << std::this_thread::get_id();
+
+    fs::path tmp = cache;
+    tmp += suffix.str();
+
+    {
+        std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+        if(!ofs.is_open()) return false;
+
+        Header header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.num_columns = static_cast<uint32_t>(_columns.size());
+        header.schema = schema;
+        header.size = stamp.size;
+        header.mtime = stamp.mtime;
+        header.fingerprint = stamp.fingerprint;
+
+        ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        size_t offset = align(sizeof(Header) + _columns.size() * sizeof(Entry));
+
+        for(const auto& column : _columns) {
+            Entry entry{ offset, column.count, column.type_size, 0 };
+            ofs.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+
+            offset = align(offset + column.count * column.type_size);
+        }
+
+        static constexpr char zeros[ALIGNMENT] = {};
+
+        for(const auto& column : _columns) {
+            size_t pos = static_cast<size_t>(ofs.tellp());
+            ofs.write(zeros, align(pos) - pos);
+            ofs.write(static_cast<const char*>(column.data), column.count * column.type_size);
+        }
+
+        if(!ofs) {
+            ofs.close();
+            fs::remove(tmp, ec);
+            return false;
+        }
+    }
+
+    fs::rename(tmp, cache, ec);
+    if(ec) fs::remove(tmp, ec);
+
+    return !ec;
+}
+
+Reader::Reader(const fs::path& cache, uint64_t schema, const Stamp& stamp)
+{
+    if(!open(cache, schema, stamp)) {
+        _file = MappedFile();
+        _num_columns = 0;
+    }
+}
+
+bool Reader::open(const fs::path& cache, uint64_t schema, const Stamp& stamp)
+{
+    if(stamp.size == 0 || !fs::exists(cache)) return false;
+
+    try {
+        _file = MappedFile(cache);
+    }
+    catch(const std::runtime_error&) {
+        return false;
+    }
+
+    if(_file.size() < sizeof(Header)) return false;
+
+    Header header;
+    std::memcpy(&header, _file.data(), sizeof(header));
+
+    if(std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.schema != schema) {
+        return false;
+    }
+
+    if(Stamp{ header.size, header.mtime, header.fingerprint } != stamp) return false;
+
+    _num_columns = header.num_columns;
+    if(sizeof(Header) + _num_columns * sizeof(Entry) > _file.size()) return false;
+
+    for(size_t i = 0; i < _num_columns; ++i) {
+        const Entry* e = entry(i);
+        if(e->offset + e->count * e->type_size > _file.size()) return false;
+    }
+
+    return true;
+}
+
+const Entry* Reader::entry(size_t i) const
+{
+    return reinterpret_cast<const Entry*>(_file.data() + sizeof(Header)) + i;
+}
+
+std::span<const std::byte> Reader::column(size_t i, size_t type_size) const
+{
+    if(i >= _num_columns) return {};
+
+    const Entry* e = entry(i);
+    if(e->type_size != type_size) return {};
+
+    return { reinterpret_cast<const std::byte*>(_file.data() + e->offset), e->count * e->type_size };
+}
+
+}
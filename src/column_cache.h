@@ -0,0 +1,184 @@
+#ifndef COLUMN_CACHE_H
+#define COLUMN_CACHE_H
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "mapped_file.h"
+
+namespace fs = std::filesystem;
+
+// Binary columnar cache of the parsed content of a result file.
+//
+// The columns parsed from a source file are written once to a sidecar file
+// (".<name>.cols" next to the source, or in $STATS_VIEWER_CACHE_DIR when
+// set). Later loads map the cache and copy the columns out instead of
+// parsing the text again. A cache is only used if the size, mtime and
+// fingerprint of the source still match and if it was written with the
+// same schema.
+namespace column_cache
+{
+
+// Identity of a source file at the time the cache was written
+struct Stamp
+{
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t fingerprint = 0;  // hash of the first and last 64 KB
+
+    bool operator==(const Stamp&) const = default;
+};
+
+Stamp stamp_of(const fs::path& source);
+
+fs::path cache_path(const fs::path& source);
+
+// Hash of a schema description, changing it invalidates every cache
+// written with the previous one
+constexpr uint64_t schema_id(std::string_view schema)
+{
+    // FNV-1a
+    uint64_t h = 14695981039346656037ull;
+    for(char c : schema) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 1099511628211ull;
+    }
+
+    return h;
+}
+
+// Location of a column in a cache file
+struct Entry;
+
+class Writer
+{
+    struct Column
+    {
+        const void* data;
+        uint64_t count;
+        uint32_t type_size;
+    };
+
+    std::vector<Column> _columns;
+
+public:
+    template<typename T>
+    void add(const std::vector<T>& column)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        _columns.push_back({ column.data(), column.size(), sizeof(T) });
+    }
+
+    // Written to a temporary file then renamed, so concurrent readers only
+    // ever see complete caches. Returns false on I/O error.
+    bool write(const fs::path& cache, uint64_t schema, const Stamp& stamp) const;
+};
+
+class Reader
+{
+    MappedFile _file;
+    size_t _num_columns = 0;
+
+    bool open(const fs::path& cache, uint64_t schema, const Stamp& stamp);
+    const Entry* entry(size_t i) const;
+
+public:
+    // Empty reader if the cache is missing, stale or corrupted
+    Reader(const fs::path& cache, uint64_t schema, const Stamp& stamp);
+
+    bool valid() const { return !_file.empty(); }
+    size_t size() const { return _num_columns; }
+
+    // Raw view of column i, empty on type mismatch
+    std::span<const std::byte> column(size_t i, size_t type_size) const;
+
+    template<typename T>
+    bool read(size_t i, std::vector<T>& out) const
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        auto bytes = column(i, sizeof(T));
+        if(bytes.data() == nullptr) return false;
+
+        out.resize(bytes.size() / sizeof(T));
+        if(!out.empty()) std::memcpy(out.data(), bytes.data(), bytes.size());
+
+        return true;
+    }
+};
+
+namespace impl
+{
+
+template<typename Columns>
+concept HasColumns = requires(Columns& c) { c.for_each_column([](auto&) {}); };
+
+// Call f on every vector of a column set, in a fixed order
+template<typename Columns, typename F>
+void for_each_column(Columns& columns, F&& f)
+{
+    if constexpr(HasColumns<Columns>) {
+        columns.for_each_column(f);
+    }
+    else {
+        // std::tuple<std::vector<Ts>...> and std::array<std::vector<T>, N>
+        std::apply([&f](auto&... column) { (f(column), ...); }, columns);
+    }
+}
+
+}
+
+// Columns of source, read from its cache when valid, otherwise produced by
+// parse() and cached for the next load. parse may take a bool& and clear
+// it to keep its result out of the cache, when it is partial for instance.
+template<typename Columns, typename Parse>
+Columns load(const fs::path& source, std::string_view schema, Parse&& parse)
+{
+    const uint64_t id = schema_id(schema);
+    const fs::path cache = cache_path(source);
+    const Stamp stamp = stamp_of(source);
+
+    Columns columns;
+
+    Reader reader(cache, id, stamp);
+    if(reader.valid()) {
+        size_t i = 0;
+        bool ok = true;
+
+        impl::for_each_column(columns, [&](auto& column) {
+            ok = ok && i < reader.size() && reader.read(i++, column);
+        });
+
+        if(ok && i == reader.size()) return columns;
+
+        std::cout << "Ignoring malformed cache : " << cache << std::endl;
+    }
+
+    bool cacheable = true;
+
+    if constexpr(std::is_invocable_v<Parse, bool&>) columns = parse(cacheable);
+    else columns = parse();
+
+    if(!cacheable) return columns;
+
+    Writer writer;
+    impl::for_each_column(columns, [&writer](const auto& column) { writer.add(column); });
+
+    if(!writer.write(cache, id, stamp)) {
+        std::cout << "Could not write cache : " << cache << std::endl;
+    }
+
+    return columns;
+}
+
+}
+
+#endif // COLUMN_CACHE_H
@@ -2,11 +2,248 @@
 #define CSV_READER_H
 
 #include <tuple>
+#include <array>
+#include <algorithm>
 #include <fstream>
+#include <sstream>
 #include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <vector>
+#include <utility>
+
+#include "mapped_file.h"
+#include "input_file.h"
+#include "csv_scan.h"
+#include "thread_pool.h"
 
 namespace fs = std::filesystem;
 
+namespace impl
+{
+
+inline std::string_view trim_field(std::string_view field)
+{
+    while(!field.empty() && (field.front() == ' ' || field.front() == '\t')) field.remove_prefix(1);
+    while(!field.empty() && (field.back() == ' ' || field.back() == '\t' || field.back() == '\r')) field.remove_suffix(1);
+    if(!field.empty() && field.front() == '+') field.remove_prefix(1);
+
+    return field;
+}
+
+// Convert a field in place. A field that does not parse yields a value
+// initialized T, like a failed stream extraction does.
+template<typename T>
+void parse_field(std::string_view field, T& value)
+{
+    if constexpr(std::is_same_v<T, std::string>) {
+        value.assign(field);
+    }
+    else {
+        field = trim_field(field);
+
+        auto [ptr, ec] = std::from_chars(field.data(), field.data() + field.size(), value);
+        if(ec != std::errc{}) value = T{};
+    }
+}
+
+}
+
+// Field cursor over a row oriented buffer
+template<const char DELIMITER>
+class RowCursor
+{
+    csv_scan::SeparatorScanner _scanner;
+    const char* _cur = nullptr;
+    const char* _end = nullptr;
+
+public:
+    RowCursor() = default;
+    RowCursor(const char* begin, const char* end)
+        : _scanner(begin, end, DELIMITER), _cur(begin), _end(end)
+    {}
+
+    const char* position() const { return _cur; }
+    bool at_end() const { return _cur == _end; }
+
+    // Consume the next field span, returns true when it closes the row
+    bool next_field(std::string_view& field) {
+        const char* sep = _scanner.next();
+        field = std::string_view(_cur, sep - _cur);
+
+        if(sep == _end) {
+            _cur = _end;
+            return true;
+        }
+
+        _cur = sep + 1;
+        return *sep == '\n';
+    }
+
+    void skip_line() {
+        std::string_view field;
+        while(!next_field(field)) {}
+    }
+
+    // Hand the N fields of the next non blank row to store(index, field).
+    // Missing fields are passed as empty spans and extra ones are skipped.
+    // Returns false once the buffer is exhausted.
+    template<size_t N, typename Store>
+    bool load_row(Store&& store) {
+        std::string_view field;
+        bool eol;
+
+        do {
+            if(at_end()) return false;
+
+            eol = next_field(field);
+
+            // skip blank lines, a trailing newline must not produce a row
+        } while(eol && impl::trim_field(field).empty());
+
+        store(std::integral_constant<size_t, 0>{}, field);
+
+        auto load_field = [&](auto index) {
+            if(eol) {
+                store(index, std::string_view{});
+            }
+            else {
+                eol = next_field(field);
+                store(index, field);
+            }
+        };
+
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (load_field(std::integral_constant<size_t, I + 1>{}), ...);
+        }(std::make_index_sequence<N - 1>{});
+
+        if(!eol) skip_line();
+
+        return true;
+    }
+};
+
+namespace impl
+{
+
+// Run store over every row of [begin, end). When these are the first rows
+// of columns, the row count of the whole input, total bytes long (end -
+// begin when 0), is estimated from the first chunk so that every column
+// is reserved once.
+template<const char DELIMITER, size_t N, typename Columns, typename Store>
+void fill_columns(const char* begin, const char* end, Columns& columns, Store&& store, size_t total = 0)
+{
+    static constexpr size_t CHUNK_ROWS = 1 << 16;
+
+    RowCursor<DELIMITER> cursor(begin, end);
+
+    size_t rows = 0;
+    while(rows < CHUNK_ROWS && cursor.template load_row<N>(store)) ++rows;
+
+    if(rows == 0) return;
+
+    bool first = (std::get<0>(columns).size() == rows);
+    size_t consumed = cursor.position() - begin;
+    if(total == 0) total = end - begin;
+
+    if(first && total > consumed) {
+        size_t estimate = rows * total / consumed + 1;
+        std::apply([estimate](auto&... column) { (column.reserve(estimate), ...); }, columns);
+    }
+
+    while(cursor.template load_row<N>(store)) {}
+}
+
+// Parse a whole file, window after window, into a single batch. The
+// columns are reserved for the whole file from its first window.
+template<const char DELIMITER, size_t N, typename Columns, typename MakeStore>
+Columns read_columns(const fs::path& p, MakeStore&& make_store)
+{
+    Columns columns;
+    LineSource source(p);
+    auto store = make_store(columns);
+
+    for(auto window = source.next(); !window.empty(); window = source.next()) {
+        fill_columns<DELIMITER, N>(window.data(), window.data() + window.size(), columns, store, source.size_hint());
+    }
+
+    return columns;
+}
+
+// Parse a file as ordered batches on pool. make_store(batch) returns the
+// store filling a batch. Small files are not split and compressed ones are
+// decompressed sequentially into a single batch.
+template<const char DELIMITER, size_t N, typename Columns, typename MakeStore>
+std::vector<Columns> read_batches(const fs::path& p, ThreadPool& pool, MakeStore&& make_store)
+{
+    static constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+
+    std::vector<Columns> batches;
+
+    if(compression_of(p) != Compression::NONE) {
+        batches.push_back(read_columns<DELIMITER, N, Columns>(p, make_store));
+        return batches;
+    }
+
+    MappedFile file(p);
+
+    size_t chunks = std::clamp<size_t>(file.size() / MIN_CHUNK_SIZE, 1, pool.size() * 4);
+    auto ranges = split_lines(file.view(), chunks);
+
+    batches.resize(ranges.size());
+    std::vector<std::future<void>> pending;
+    pending.reserve(ranges.size());
+
+    for(size_t i = 0; i < ranges.size(); ++i) {
+        pending.push_back(pool.submit([&ranges, &batches, &make_store, i]() {
+            fill_columns<DELIMITER, N>(ranges[i].data(), ranges[i].data() + ranges[i].size(), batches[i], make_store(batches[i]));
+        }));
+    }
+
+    pool.wait(pending);
+    for(auto& f : pending) f.get(); // rethrow parsing errors
+
+    return batches;
+}
+
+// Concatenate ordered batches column by column
+template<typename Columns>
+Columns merge_batches(std::vector<Columns>&& batches)
+{
+    if(batches.size() == 1) return std::move(batches.front());
+
+    Columns merged;
+
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        auto merge_column = [&batches](auto& column, auto index) {
+            size_t total = 0;
+            for(const auto& b : batches) total += std::get<index>(b).size();
+
+            column.reserve(total);
+            for(auto& b : batches) {
+                auto& part = std::get<index>(b);
+                column.insert(column.end(), part.begin(), part.end());
+                part = {};
+            }
+        };
+
+        (merge_column(std::get<I>(merged), std::integral_constant<size_t, I>{}), ...);
+    }(std::make_index_sequence<std::tuple_size_v<Columns>>{});
+
+    return merged;
+}
+
+}
+
+// Csv reader walking the file in place: plain files are memory mapped,
+// compressed ones are decompressed block by block. Every field is converted
+// with std::from_chars, no intermediate string or stream is built.
+// Separators are located a block at a time by the csv_scan kernels.
+//
+// Rows are either iterated as tuples, or read_columns() fills one
+// contiguous vector per column.
 template<const char DELIMITER, typename... Ts>
 class CsvReader
 {
@@ -14,12 +251,193 @@ class CsvReader
 
 public:
 
+    using columns_type = std::tuple<std::vector<Ts>...>;
+
     CsvReader(fs::path p) : _path(std::move(p)) {}
 
     class iterator
     {
         friend CsvReader;
 
+        std::shared_ptr<LineSource> _source;
+        std::tuple<Ts...> _line;
+        RowCursor<DELIMITER> _cursor;
+        bool _finish = false;
+
+        void load_line() {
+            auto store = [this](auto index, std::string_view field) {
+                impl::parse_field(field, std::get<index>(_line));
+            };
+
+            while(!_cursor.template load_row<sizeof...(Ts)>(store)) {
+                auto window = _source->next();
+                if(window.empty()) {
+                    _finish = true;
+                    return;
+                }
+
+                _cursor = RowCursor<DELIMITER>(window.data(), window.data() + window.size());
+            }
+        }
+
+        explicit iterator(bool f) : _finish(f) {}
+
+    public:
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::tuple<Ts...>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = value_type*;
+        using reference = value_type&;
+
+        explicit iterator(const fs::path& p) : _source(std::make_shared<LineSource>(p))
+        {
+            load_line();
+        }
+
+        iterator& operator++() {
+            load_line();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator retval = *this;
+            ++(*this);
+            return retval;
+        }
+
+        bool operator==(const iterator& other) const {
+            return (_finish && other._finish) || (_finish == other._finish && _cursor.position() == other._cursor.position());
+        }
+        bool operator!=(const iterator& other) const { return !(*this == other); }
+
+        const value_type& operator*() const { return _line; }
+    };
+
+    iterator begin() { return iterator(_path); }
+    iterator end() { return iterator(true); }
+
+    // Parse the whole file column wise, fields are converted straight into
+    // their column without going through a row tuple.
+    columns_type read_columns() {
+        return impl::read_columns<DELIMITER, sizeof...(Ts), columns_type>(_path, store);
+    }
+
+    // Parse chunks of the file in parallel, batches are in file order
+    std::vector<columns_type> read_batches(ThreadPool& pool = ThreadPool::global()) {
+        return impl::read_batches<DELIMITER, sizeof...(Ts), columns_type>(_path, pool, store);
+    }
+
+    // Parallel read_columns()
+    columns_type read_columns_parallel(ThreadPool& pool = ThreadPool::global()) {
+        return impl::merge_batches(read_batches(pool));
+    }
+
+private:
+
+    static auto store(columns_type& columns) {
+        return [&columns](auto index, std::string_view field) {
+            impl::parse_field(field, std::get<index>(columns).emplace_back());
+        };
+    }
+};
+
+template<size_t N>
+struct FixedString
+{
+    char value[N];
+
+    constexpr FixedString(const char (&str)[N]) { std::copy_n(str, N, value); }
+    constexpr std::string_view view() const { return {value, N - 1}; }
+};
+
+// Ordered list of the column names of a csv file
+template<FixedString... Names>
+struct CsvSchema
+{
+    static constexpr size_t size = sizeof...(Names);
+    static constexpr std::array<std::string_view, size> names{ Names.view()... };
+
+    static constexpr size_t index_of(std::string_view name) {
+        for(size_t i = 0; i < size; ++i) {
+            if(names[i] == name) return i;
+        }
+
+        return size;
+    }
+
+    static constexpr bool contains(std::string_view name) { return index_of(name) != size; }
+};
+
+// Csv reader parsing only the named Columns of a Schema, every other field
+// is skipped without being converted and fields past the last projected
+// column are not even split. Columns are returned in projection order.
+template<const char DELIMITER, typename Schema, typename T, FixedString... Columns>
+class ProjectedCsvReader
+{
+    static_assert(sizeof...(Columns) > 0, "Projection must name at least one column");
+    static_assert((Schema::contains(Columns.view()) && ...), "Projected column is not part of the schema");
+
+    static constexpr std::array<size_t, sizeof...(Columns)> _indices{ Schema::index_of(Columns.view())... };
+
+    // projection slot of each schema column, -1 for skipped ones
+    static constexpr auto _slots = [] {
+        std::array<int, Schema::size> slots;
+        slots.fill(-1);
+
+        for(size_t i = 0; i < _indices.size(); ++i) slots[_indices[i]] = static_cast<int>(i);
+
+        return slots;
+    }();
+
+    static constexpr size_t _num_fields = *std::max_element(_indices.begin(), _indices.end()) + 1;
+
+    fs::path _path;
+
+public:
+
+    using columns_type = std::array<std::vector<T>, sizeof...(Columns)>;
+
+    ProjectedCsvReader(fs::path p) : _path(std::move(p)) {}
+
+    columns_type read_columns() {
+        return impl::read_columns<DELIMITER, _num_fields, columns_type>(_path, store);
+    }
+
+    // Parse chunks of the file in parallel, batches are in file order
+    std::vector<columns_type> read_batches(ThreadPool& pool = ThreadPool::global()) {
+        return impl::read_batches<DELIMITER, _num_fields, columns_type>(_path, pool, store);
+    }
+
+    // Parallel read_columns()
+    columns_type read_columns_parallel(ThreadPool& pool = ThreadPool::global()) {
+        return impl::merge_batches(read_batches(pool));
+    }
+
+private:
+
+    static auto store(columns_type& columns) {
+        return [&columns](auto index, std::string_view field) {
+            constexpr int slot = _slots[index];
+            if constexpr(slot >= 0) impl::parse_field(field, columns[slot].emplace_back());
+        };
+    }
+};
+
+// Original istream based reader, kept as the baseline for csv_bench
+template<const char DELIMITER, typename... Ts>
+class StreamCsvReader
+{
+    fs::path _path;
+
+public:
+
+    StreamCsvReader(fs::path p) : _path(std::move(p)) {}
+
+    class iterator
+    {
+        friend StreamCsvReader;
+
         std::tuple<Ts...> _line;
         std::ifstream _ifs;
         std::istringstream _iss;
@@ -73,12 +491,6 @@ public:
             return *this;
         }
 
-        iterator operator++(int) {
-            iterator retval = *this;
-            ++(*this);
-            return retval;
-        }
-
         bool operator==(const iterator& other) const { return (_finish == other._finish) || (_line == other._line); }
         bool operator!=(const iterator& other) const { return !(*this == other); }
 
@@ -92,30 +504,33 @@ public:
 namespace impl
 {
 
-template<const char DELIMITER, size_t NUM, typename... Ts>
+template<template<char, typename...> class Reader, const char DELIMITER, size_t NUM, typename... Ts>
 struct TypeDuplicator;
 
-template<const char DELIMITER, size_t NUM, typename T, typename... Ts>
-struct TypeDuplicator<DELIMITER,NUM, T, Ts...>
+template<template<char, typename...> class Reader, const char DELIMITER, size_t NUM, typename T, typename... Ts>
+struct TypeDuplicator<Reader, DELIMITER,NUM, T, Ts...>
 {
-    using Type = TypeDuplicator<DELIMITER, NUM-1, T, T, Ts...>::Type;
+    using Type = TypeDuplicator<Reader, DELIMITER, NUM-1, T, T, Ts...>::Type;
 };
 
-template<const char DELIMITER, size_t NUM, typename T>
-struct TypeDuplicator<DELIMITER,NUM, T>
+template<template<char, typename...> class Reader, const char DELIMITER, size_t NUM, typename T>
+struct TypeDuplicator<Reader, DELIMITER,NUM, T>
 {
-    using Type = TypeDuplicator<DELIMITER,NUM-1, T, T>::Type;
+    using Type = TypeDuplicator<Reader, DELIMITER,NUM-1, T, T>::Type;
 };
 
-template<const char DELIMITER, typename T, typename... Ts>
-struct TypeDuplicator<DELIMITER, 0,T, Ts...>
+template<template<char, typename...> class Reader, const char DELIMITER, typename T, typename... Ts>
+struct TypeDuplicator<Reader, DELIMITER, 0,T, Ts...>
 {
-    using Type = CsvReader<DELIMITER, Ts...>;
+    using Type = Reader<DELIMITER, Ts...>;
 };
 
 }
 
 template<const char DELIMITER, typename T, size_t NUM>
-using CsvReaderTypeRepeat = impl::TypeDuplicator<DELIMITER, NUM, T>::Type;
+using CsvReaderTypeRepeat = impl::TypeDuplicator<CsvReader, DELIMITER, NUM, T>::Type;
+
+template<const char DELIMITER, typename T, size_t NUM>
+using StreamCsvReaderTypeRepeat = impl::TypeDuplicator<StreamCsvReader, DELIMITER, NUM, T>::Type;
 
 #endif // CSV_READER_H
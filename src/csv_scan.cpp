@@ -0,0 +1,109 @@
+#include "csv_scan.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CSV_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace csv_scan
+{
+
+Masks scan_scalar(const char* p, size_t n, char delimiter)
+{
+    Masks m;
+
+    for(size_t i = 0; i < n && i < BLOCK_SIZE; ++i) {
+        if(p[i] == delimiter) m.delimiter |= (uint64_t{1} << i);
+        else if(p[i] == '\n') m.newline |= (uint64_t{1} << i);
+    }
+
+    return m;
+}
+
+namespace
+{
+
+Masks scan_block_scalar(const char* p, char delimiter)
+{
+    return scan_scalar(p, BLOCK_SIZE, delimiter);
+}
+
+#ifdef CSV_SCAN_X86
+
+__attribute__((target("sse2")))
+Masks scan_block_sse2(const char* p, char delimiter)
+{
+    const __m128i delim = _mm_set1_epi8(delimiter);
+    const __m128i nl = _mm_set1_epi8('\n');
+
+    Masks m;
+
+    for(int i = 0; i < 4; ++i) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+
+        auto d = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, delim)));
+        auto n = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, nl)));
+
+        m.delimiter |= uint64_t{d} << (16 * i);
+        m.newline |= uint64_t{n} << (16 * i);
+    }
+
+    return m;
+}
+
+__attribute__((target("avx2")))
+Masks scan_block_avx2(const char* p, char delimiter)
+{
+    const __m256i delim = _mm256_set1_epi8(delimiter);
+    const __m256i nl = _mm256_set1_epi8('\n');
+
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+
+    auto d_lo = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, delim)));
+    auto d_hi = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, delim)));
+    auto n_lo = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, nl)));
+    auto n_hi = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, nl)));
+
+    return Masks{ uint64_t{d_lo} | (uint64_t{d_hi} << 32), uint64_t{n_lo} | (uint64_t{n_hi} << 32) };
+}
+
+#endif
+
+struct Kernel
+{
+    ScanBlockFn fn;
+    const char* name;
+};
+
+Kernel select_kernel()
+{
+#ifdef CSV_SCAN_X86
+    __builtin_cpu_init();
+
+    if(__builtin_cpu_supports("avx2")) return { scan_block_avx2, "avx2" };
+    if(__builtin_cpu_supports("sse2")) return { scan_block_sse2, "sse2" };
+#endif
+
+    return { scan_block_scalar, "scalar" };
+}
+
+const Kernel& kernel()
+{
+    static const Kernel k = select_kernel();
+    return k;
+}
+
+}
+
+ScanBlockFn scan_block()
+{
+    return kernel().fn;
+}
+
+const char* kernel_name()
+{
+    return kernel().name;
+}
+
+}
@@ -0,0 +1,81 @@
+#ifndef CSV_SCAN_H
+#define CSV_SCAN_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace csv_scan
+{
+
+static constexpr size_t BLOCK_SIZE = 64;
+
+// Position bitmasks of one block : bit i is set when p[i] is a delimiter
+// (resp. a newline)
+struct Masks
+{
+    uint64_t delimiter = 0;
+    uint64_t newline = 0;
+};
+
+// Scan a full BLOCK_SIZE block
+using ScanBlockFn = Masks (*)(const char* p, char delimiter);
+
+// Kernel selected once at runtime : AVX2, SSE2 or scalar
+ScanBlockFn scan_block();
+
+// Scalar kernel, also used for the last partial block of a buffer
+Masks scan_scalar(const char* p, size_t n, char delimiter);
+
+const char* kernel_name();
+
+// Walk a buffer separator by separator (delimiter or newline), one block
+// of positions is computed at a time and consumed bit by bit.
+class SeparatorScanner
+{
+    const char* _base = nullptr;
+    const char* _end = nullptr;
+    uint64_t _mask = 0;
+    char _delimiter;
+    ScanBlockFn _scan;
+
+    bool advance() {
+        _base += BLOCK_SIZE;
+        return load();
+    }
+
+    bool load() {
+        if(_base >= _end) return false;
+
+        auto n = static_cast<size_t>(_end - _base);
+        Masks m = (n >= BLOCK_SIZE) ? _scan(_base, _delimiter) : scan_scalar(_base, n, _delimiter);
+        _mask = m.delimiter | m.newline;
+
+        return true;
+    }
+
+public:
+    SeparatorScanner() = default;
+
+    SeparatorScanner(const char* begin, const char* end, char delimiter)
+        : _base(begin), _end(end), _delimiter(delimiter), _scan(scan_block())
+    {
+        load();
+    }
+
+    // Next separator, or end of buffer when there is none left
+    const char* next() {
+        while(_mask == 0) {
+            if(!advance()) return _end;
+        }
+
+        const char* sep = _base + std::countr_zero(_mask);
+        _mask &= _mask - 1;
+
+        return sep;
+    }
+};
+
+}
+
+#endif // CSV_SCAN_H
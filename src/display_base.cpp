@@ -1,10 +1,17 @@
 #include "display_base.h"
 #include "stats_line_chart.h"
+#include "lod.h"
 
 #include <QTabWidget>
 #include <QListWidget>
 #include <QTreeWidget>
 #include <QHeaderView>
+#include <QValueAxis>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <set>
 
 DisplayBase::DisplayBase(QWidget* tab, QListWidget* legend, QTreeWidget* info)
     : _tab(tab), _legend(legend), _info(info)
@@ -37,33 +44,88 @@ StatsLineChartView * DisplayBase::create_chart_view(QChart* chart)
 
 void DisplayBase::create_legend()
 {
-    StatMap& map = _path_keys["legend"];
-    init_map(map);
+    init_map(_legend_slots);
 
-    for(auto it = map.cbegin(); it != map.cend(); ++it) {
+    _legend_slots.for_each([this](uint8_t key, const Slot& slot) {
         QListWidgetItem * item = new QListWidgetItem(_legend);
         item->setFlags(Qt::ItemIsUserCheckable | Qt::ItemIsEnabled);
         item->setCheckState(Qt::Unchecked);
-        item->setText(std::get<StatsKeyProperty::NAME>(it.value()));
-        item->setData(1, static_cast<uint8_t>(it.key()));
-    }
+        item->setText(slot.name);
+        item->setData(1, key);
+    });
+
+    QObject::connect(_legend, &QListWidget::itemChanged, _legend, [this](QListWidgetItem* item) -> void {
+        uint8_t key = item->data(1).toUInt();
+        bool show = item->checkState() == Qt::Checked;
+
+        _legend_slots[key].show = show;
+
+        bool built = false;
+
+        for(auto& [path, exp] : _experiments) {
+            auto& slot = (*exp)[key];
+            slot.show = show;
+
+            if(materialize(exp.get(), key)) {
+                set_makeup(path.toStdString());
+                built = true;
+            }
+
+            if(slot.serie == nullptr) continue;
+
+            if(show) slot.serie->show();
+            else slot.serie->hide();
+        }
+
+        // axes for the new series
+        if(built) update_charts();
+
+        if(auto* chart = _legend_slots[key].chart) update_detail(chart);
+    });
+}
+
+DisplayBase::ExpHandle DisplayBase::find_experiment(const fs::path& p) const
+{
+    auto it = _experiments.find(p.c_str());
+    return (it != _experiments.end()) ? it->second.get() : nullptr;
+}
+
+DisplayBase::ExpHandle DisplayBase::experiment(const fs::path& p)
+{
+    auto& exp = _experiments[p.c_str()];
+    if(exp) return exp.get();
+
+    exp = std::make_unique<Experiment>();
+    init_map(*exp);
+
+    // the catalog already holds the tags of the experiments it knows
+    const auto* entry = _catalog ? _catalog->find(p) : nullptr;
+    auto info = get_info(entry ? *entry : ExperimentCatalog::tags_of(p));
+
+    exp->for_each([&info](uint8_t, Slot& slot) {
+        if(slot.info.editable) slot.info = info;
+    });
+
+    return exp.get();
 }
 
 void DisplayBase::unload(const fs::path& path)
 {
-    auto map = _path_keys[path.c_str()];
+    // not loaded, or its parse was cancelled
+    auto found = _experiments.find(path.c_str());
+    if(found == _experiments.end()) return;
 
-    for(auto& it : map) {
-        auto s = std::get<StatsKeyProperty::SERIE>(it);
-        auto* chart = std::get<StatsKeyProperty::CHART>(it);
+    std::set<QChart*> charts;
 
-        if(chart && s) {
-            chart->removeSeries(s);
-            delete s;
+    found->second->for_each([&charts](uint8_t, Slot& slot) {
+        if(slot.chart && slot.serie) {
+            slot.chart->removeSeries(slot.serie);
+            delete slot.serie;
+            charts.insert(slot.chart);
         }
 
-        std::get<StatsKeyProperty::SERIE>(it) = nullptr;
-    }
+        slot.serie = nullptr;
+    });
 
     auto item = _info->findItems(path.filename().c_str(), Qt::MatchExactly);
 
@@ -72,79 +134,225 @@ void DisplayBase::unload(const fs::path& path)
         delete it;
     }
 
-    _path_keys.remove(path.c_str());
+    _experiments.erase(found);
+
+    // the budget of the removed series goes to the remaining ones
+    for(auto* chart : charts) update_detail(chart);
 }
 
-void DisplayBase::set_info(const fs::path& path)
+void DisplayBase::defer_serie(ExpHandle exp, uint8_t key, std::function<void()> build)
 {
-    auto info = get_info(path);
+    auto& slot = (*exp)[key];
+    slot.build = std::move(build);
+    slot.show = _legend_slots[key].show;
 
-    auto& map = _path_keys[path.c_str()];
+    materialize(exp, key);
+}
 
-    // qInfo() << info.stream << " " << info.cc << " " << info.impl;
+bool DisplayBase::materialize(ExpHandle exp, uint8_t key)
+{
+    auto& slot = (*exp)[key];
+    if(!slot.show || !slot.build) return false;
 
-    for(auto& it : map) {
-        auto info_tmp = std::get<StatsKeyProperty::INFO>(it);
-        if(info_tmp.editable) std::get<StatsKeyProperty::INFO>(it) = info;
+    auto build = std::move(slot.build);
+    slot.build = nullptr;
+
+    build();
+    return true;
+}
+
+void DisplayBase::Staged::index()
+{
+    // series read from the same rows share their x
+    std::vector<std::shared_ptr<const lod::TimeColumn>> times;
+
+    for(size_t key = 0; key < MAX_KEYS; ++key) {
+        if(points[key].empty()) continue;
+
+        auto time = std::find_if(times.begin(), times.end(), [this, key](const auto& t) { return t->same_as(points[key]); });
+
+        pyramids[key] = lod::make_pyramid(points[key], (time != times.end()) ? *time : nullptr);
+        if(!pyramids[key]) continue;
+
+        if(time == times.end()) times.push_back(pyramids[key]->time());
+        points[key] = {};
     }
 }
 
-DisplayBase::ExpInfo DisplayBase::get_info(const fs::path& path)
+void DisplayBase::set_points(ExpHandle exp, uint8_t key, const QList<QPointF>& points)
 {
-    ExpInfo info;
+    auto& slot = (*exp)[key];
 
-    for(auto& it : path) {
-        if(it == "streams" || it == "stream") {
-            info.stream = true;
-        }
-        else if(it == "dgrams" || it == "dgram") {
-            info.stream = false;
-        }
-        else if(it == "mvfst") {
-            info.impl = QuicImpl::MVFST;
-            info.impl_str = it.c_str();
-        }
-        else if(it == "quicgo") {
-            info.impl = QuicImpl::QUICGO;
-            info.impl_str = it.c_str();
-        }
-        else if(it == "quiche") {
-            info.impl = QuicImpl::QUICHE;
-            info.impl_str = it.c_str();
-        }
-        else if(it == "msquic") {
-            info.impl = QuicImpl::MSQUIC;
-            info.impl_str = it.c_str();
-        }
-        else if(it == "udp") {
-            info.impl = QuicImpl::UDP;
-            info.impl_str = it.c_str();
-        }
-        else if(it == "bbr") {
-            info.cc = CCAlgo::BBR;
-            info.cc_str = it.c_str();
-        }
-        else if(it == "newreno") {
-            info.cc = CCAlgo::NEWRENO;
-            info.cc_str = it.c_str();
-        }
-        else if(it == "none") {
-            info.cc = CCAlgo::NONE;
-            info.cc_str = it.c_str();
+    auto* serie = dynamic_cast<QXYSeries*>(slot.serie);
+    if(!serie) return;
+
+    auto pyramid = slot.chart ? lod::make_pyramid(points) : nullptr;
+
+    // the list is shared, not copied
+    if(pyramid) set_detail(exp, key, std::move(pyramid));
+    else serie->replace(points);
+}
+
+void DisplayBase::set_detail(ExpHandle exp, uint8_t key, std::shared_ptr<const lod::Pyramid> pyramid)
+{
+    auto& slot = (*exp)[key];
+
+    auto* serie = dynamic_cast<QXYSeries*>(slot.serie);
+    if(!serie) return;
+
+    if(!slot.chart) {
+        serie->replace(pyramid->points());
+        return;
+    }
+
+    slot.detail = std::move(pyramid);
+    show_detail(slot, slot.detail->point(0).x(), slot.detail->point(slot.detail->size() - 1).x());
+}
+
+void DisplayBase::show_detail(Slot& slot, double x_min, double x_max)
+{
+    size_t visible = std::accumulate(_visible_series.cbegin(), _visible_series.cend(), size_t{0});
+    size_t columns = std::max<size_t>(1, lod::point_budget() / std::max<size_t>(1, visible) / 2);
+
+    // no more than one column per pixel
+    auto width = slot.chart->plotArea().width();
+    if(width >= 1) columns = std::min<size_t>(columns, width);
+
+    static_cast<QXYSeries*>(slot.serie)->replace(slot.detail->query(x_min, x_max, columns));
+}
+
+void DisplayBase::update_detail(QChart* chart, bool whole)
+{
+    QValueAxis* axis = nullptr;
+    if(!whole) {
+        auto axes = chart->axes(Qt::Horizontal);
+        if(!axes.empty()) axis = qobject_cast<QValueAxis*>(axes.front());
+    }
+
+    std::vector<Slot*> slots;
+    size_t visible = 0;
+
+    for(auto& [_, exp] : _experiments) {
+        for(auto& slot : exp->slots()) {
+            if(slot.chart != chart || !slot.detail || !slot.serie) continue;
+
+            bool shown = slot.serie->isVisible();
+            visible += shown;
+
+            // hidden series are brought up to date when shown
+            if(whole || shown) slots.push_back(&slot);
         }
-        else if(it == "copa") {
-            info.cc = CCAlgo::COPA;
-            info.cc_str = it.c_str();
+    }
+
+    if(visible) _visible_series[chart] = visible;
+    else _visible_series.remove(chart);
+
+    auto animations = chart->animationOptions();
+    chart->setAnimationOptions(QChart::NoAnimation);
+
+    for(auto* slot : slots) {
+        if(axis) show_detail(*slot, axis->min(), axis->max());
+        else show_detail(*slot, slot->detail->point(0).x(), slot->detail->point(slot->detail->size() - 1).x());
+    }
+
+    chart->setAnimationOptions(animations);
+}
+
+void DisplayBase::refresh_all()
+{
+    std::set<QChart*> charts;
+    _legend_slots.for_each([&charts](uint8_t, const Slot& slot) {
+        if(slot.chart) charts.insert(slot.chart);
+    });
+
+    // the default axes fit the series as they are, zoomed series would
+    // narrow them
+    for(auto* chart : charts) update_detail(chart, true);
+
+    refresh_charts();
+
+    for(auto* chart : charts) {
+        for(auto* axis : chart->axes(Qt::Horizontal)) {
+            auto* value_axis = qobject_cast<QValueAxis*>(axis);
+            if(!value_axis) continue;
+
+            QObject::connect(value_axis, &QValueAxis::rangeChanged, value_axis, [this, chart]() { update_detail(chart); });
         }
-        else if(it == "cubic") {
-            info.cc = CCAlgo::CUBIC;
-            info.cc_str = it.c_str();
+    }
+}
+
+void DisplayBase::attach_points(ExpHandle exp, const Staged& staged)
+{
+    for(size_t key = 0; key < MAX_KEYS; ++key) {
+        if(staged.pyramids[key]) set_detail(exp, key, staged.pyramids[key]);
+        else if(!staged.points[key].empty()) set_points(exp, key, staged.points[key]);
+    }
+
+    for(size_t key = 0; key < MAX_KEYS; ++key) {
+        if(staged.boxes[key].empty()) continue;
+
+        auto* serie = dynamic_cast<QBoxPlotSeries*>((*exp)[key].serie);
+        if(!serie) continue;
+
+        QList<QBoxSet*> sets;
+        for(const auto& box : staged.boxes[key]) {
+            auto set = new QBoxSet(box.label);
+            set->setValue(QBoxSet::LowerExtreme, box.lower_extreme);
+            set->setValue(QBoxSet::LowerQuartile, box.lower_quartile);
+            set->setValue(QBoxSet::Median, box.median);
+            set->setValue(QBoxSet::UpperQuartile, box.upper_quartile);
+            set->setValue(QBoxSet::UpperExtreme, box.upper_extreme);
+            sets << set;
         }
+
+        serie->append(sets);
+    }
+}
+
+DisplayBase::ExpInfo DisplayBase::get_info(const ExperimentCatalog::Experiment& tags)
+{
+    static const std::map<std::string, QuicImpl> IMPLS{
+        { "mvfst", QuicImpl::MVFST },
+        { "quicgo", QuicImpl::QUICGO },
+        { "quiche", QuicImpl::QUICHE },
+        { "msquic", QuicImpl::MSQUIC },
+        { "udp", QuicImpl::UDP }
+    };
+
+    static const std::map<std::string, CCAlgo> CCS{
+        { "bbr", CCAlgo::BBR },
+        { "newreno", CCAlgo::NEWRENO },
+        { "none", CCAlgo::NONE },
+        { "copa", CCAlgo::COPA },
+        { "cubic", CCAlgo::CUBIC }
+    };
+
+    ExpInfo info;
+    info.stream = tags.stream;
+
+    if(auto it = IMPLS.find(tags.impl); it != IMPLS.end()) {
+        info.impl = it->second;
+        info.impl_str = QString::fromStdString(tags.impl);
+    }
+
+    if(auto it = CCS.find(tags.cc); it != CCS.end()) {
+        info.cc = it->second;
+        info.cc_str = QString::fromStdString(tags.cc);
     }
 
     return info;
 }
 
+void DisplayBase::add_percentiles(QTreeWidgetItem* root, const QString& name, const Percentiles& percentiles)
+{
+    for(size_t i = 0; i < percentiles.size(); ++i) {
+        if(std::isnan(percentiles[i])) continue;
+
+        QTreeWidgetItem * item = new QTreeWidgetItem(root);
+        item->setText(0, (name.isEmpty() ? QString() : name + " ") + QString("p%1").arg(PERCENTILES_PER_MILLE[i] / 10.));
+        item->setText(1, QString::number(percentiles[i]));
+    }
+}
 
 QColor DisplayBase::get_color(const DisplayBase::ExpInfo& info)
 {
@@ -7,9 +7,23 @@
 #include <QLineSeries>
 #include <QBoxPlotSeries>
 
+#include <array>
+#include <charconv>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
 #include <optional>
+#include <ranges>
+#include <span>
+#include <stop_token>
+#include <string_view>
+
+#include "experiment_catalog.h"
+#include "lod.h"
+#include "percentiles.h"
+#include "row_stats.h"
 
 namespace fs = std::filesystem;
 
@@ -20,6 +34,7 @@ class QSeries;
 class StatsLineChart;
 class StatsLineChartView;
 class QTreeWidget;
+class QTreeWidgetItem;
 
 class DisplayBase
 {
@@ -56,125 +71,219 @@ protected:
         std::optional<QColor> color;
     };
 
-    using StatMap = QMap<uint8_t, std::tuple<QString, QAbstractSeries*, QChart*, ExpInfo, bool>>;
-    QMap<QString, StatMap> _path_keys;
+    // above the StatKey of every display
+    static constexpr size_t MAX_KEYS = 64;
+
+    struct Slot
+    {
+        QString name;
+        QAbstractSeries* serie = nullptr;
+        QChart* chart = nullptr;
+        ExpInfo info;
+        bool show = false;
+
+        // every point, the serie only gets the visible ones, decimated
+        std::shared_ptr<const lod::Pyramid> detail;
+
+        // derived serie, built the first time it is shown
+        std::function<void()> build;
+    };
+
+    // Series of one experiment, or of the legend, indexed by the StatKey of
+    // the display. Keys are declared by init_map, the others are created
+    // empty on first access.
+    class Experiment
+    {
+        std::array<std::optional<Slot>, MAX_KEYS> _slots;
+
+    public:
+        void declare(uint8_t key, Slot slot) { _slots[key] = std::move(slot); }
+
+        Slot& operator[](uint8_t key)
+        {
+            if(!_slots[key]) _slots[key].emplace();
+            return *_slots[key];
+        }
+
+        // declared slots, in key order
+        auto slots()
+        {
+            return _slots | std::views::filter([](const auto& slot) { return slot.has_value(); })
+                          | std::views::transform([](auto& slot) -> Slot& { return *slot; });
+        }
+
+        template<typename F>
+        void for_each(F&& f)
+        {
+            for(size_t key = 0; key < MAX_KEYS; ++key) {
+                if(_slots[key]) f(static_cast<uint8_t>(key), *_slots[key]);
+            }
+        }
+    };
+
+    // Stable until the experiment is unloaded
+    using ExpHandle = Experiment*;
+
+    // paths are only looked up when an experiment is loaded or unloaded
+    std::map<QString, std::unique_ptr<Experiment>> _experiments;
+    Experiment _legend_slots;
+
+    // nullptr if p is not loaded
+    ExpHandle find_experiment(const fs::path& p) const;
+
+    // Slots of p, declared by init_map when p was not loaded yet
+    ExpHandle experiment(const fs::path& p);
 
     QWidget     * _tab;
     QListWidget * _legend;
     QTreeWidget * _info;
 
-    enum StatsKeyProperty : uint8_t
+    // files of an experiment are resolved through it when set
+    std::shared_ptr<const ExperimentCatalog> _catalog;
+
+    // visible decimated series of each chart with any, they share the
+    // point budget
+    QMap<const QChart*, size_t> _visible_series;
+
+    struct Box
     {
-        NAME,
-        SERIE,
-        CHART,
-        INFO,
-        SHOW,
-        NUM_KEY
+        QString label;
+        qreal lower_extreme, lower_quartile, median, upper_quartile, upper_extreme;
     };
 
-    template<typename T>
-    double find_median(const std::vector<T>& values, int begin, int end)
+    // Points of the series of one experiment, computed off the GUI thread
+    // then handed to the series created for it by attach_points
+    struct Staged
     {
-        int count = end - begin;
-        if (count % 2) {
-            return (double)values.at(count / 2 + begin);
-        } else {
-            qreal right = values.at(count / 2 + begin);
-            qreal left = values.at(count / 2 - 1 + begin);
-            return (right + left) / 2.0;
+        std::array<QList<QPointF>, MAX_KEYS> points;
+        std::array<QList<Box>, MAX_KEYS> boxes;
+        std::array<std::shared_ptr<const lod::Pyramid>, MAX_KEYS> pyramids;
+
+        // Build the pyramids of the points once they are all added, so that
+        // the GUI thread does not have to. The points of a key are released
+        // once its pyramid holds them.
+        void index();
+
+        void reserve(uint8_t key, qsizetype size) { points[key].reserve(size); }
+
+        void add_point(uint8_t key, const QPointF& point) { points[key] << point; }
+        void add_points(uint8_t key, const QList<QPointF>& list) { points[key] << list; }
+
+        void add_box(uint8_t key, const QString& label, const RowStats& stats)
+        {
+            boxes[key] << Box{ label, stats.min, stats.lower_quartile, stats.median, stats.upper_quartile, stats.max };
         }
-    }
+    };
 
-    template<typename T>
-    void add_point(const QString& path, uint8_t key, const T& point)
-    {
-        auto map = _path_keys[path];
-        auto s = static_cast<QLineSeries*>(std::get<StatsKeyProperty::SERIE>(map[key]));
-        if(s) *s << point;
-    }
+    // Replace the points of a serie at once, with a single change notification.
+    // Series of a chart sorted by x are decimated through a pyramid, see
+    // lod.h.
+    void set_points(ExpHandle exp, uint8_t key, const QList<QPointF>& points);
+    void set_detail(ExpHandle exp, uint8_t key, std::shared_ptr<const lod::Pyramid> pyramid);
 
-    template<typename T>
-    void add_point(const QString& path, uint8_t key, const QString& label, const std::vector<T>& values)
-    {
-        auto map = _path_keys[path];
-        auto serie = static_cast<QBoxPlotSeries*>(std::get<StatsKeyProperty::SERIE>(map[key]));
-
-        int count = values.size();
-        auto box = new QBoxSet(label);
-        box->setValue(QBoxSet::LowerExtreme, values.front());
-        box->setValue(QBoxSet::UpperExtreme, values.back());
-        box->setValue(QBoxSet::Median, find_median(values, 0, count));
-        box->setValue(QBoxSet::LowerQuartile, find_median(values, 0, count / 2));
-        box->setValue(QBoxSet::UpperQuartile, find_median(values, count / 2 + (count % 2), count));
-        serie->append(box);
-    }
+    // Points of [x_min, x_max] of a decimated serie, within its share of
+    // the point budget
+    void show_detail(Slot& slot, double x_min, double x_max);
 
-    template<typename T>
+    // Decimate the visible series of chart again for its x axis range, or
+    // every serie over its whole extent
+    void update_detail(QChart* chart, bool whole = false);
+
+    // GUI thread, after the create_serie of the staged keys
+    void attach_points(ExpHandle exp, const Staged& staged);
+
+    // Values of a stat line row are only kept summarized
     struct StatLinePoint {
         float time;
-        std::vector<T> values;
+        RowStats stats;
     };
 
+    // Summarize the next row into pts.back(), its values parsed as T
     template<typename T>
-    bool get_csv_line(std::ifstream& ifs, std::vector<StatLinePoint<T>>& pts)
+    static bool get_csv_line(std::istream& ifs, std::vector<StatLinePoint>& pts)
     {
         std::string line_str;
-
         if(!std::getline(ifs, line_str)) return false;
-        std::replace(line_str.begin(), line_str.end(), ',', ' ');
-        std::istringstream iss(line_str);
 
-        iss >> pts.back().time;
-        for(T val; iss >> val;) {
-            if(val != -1) pts.back().values.push_back(val);
+        // reused by the rows parsed on this thread
+        thread_local std::vector<T> values;
+        values.clear();
+
+        std::string_view line = line_str;
+        auto is_separator = [](char c) { return c == ',' || c == ' ' || c == '\t' || c == '\r'; };
+
+        bool first = true;
+        for(size_t i = 0; i < line.size();) {
+            if(is_separator(line[i])) {
+                ++i;
+                continue;
+            }
+
+            T val{};
+            auto [end, ec] = first ? std::from_chars(line.data() + i, line.data() + line.size(), pts.back().time)
+                                   : std::from_chars(line.data() + i, line.data() + line.size(), val);
+            if(ec != std::errc{}) break;
+
+            if(!first && val != -1) values.push_back(val);
+
+            first = false;
+            i = end - line.data();
         }
 
-        std::sort(pts.back().values.begin(), pts.back().values.end());
+        pts.back().stats = row_stats(std::span<T>(values));
 
         return true;
     }
 
-    template<typename T>
-    double get_average(const std::vector<T>& values)
+    // Rows of a stat line file, kept for the series derived from them
+    using StatLineRows = std::shared_ptr<const std::vector<StatLinePoint>>;
+
+    static StatLineRows share_rows(std::vector<StatLinePoint>&& rows)
     {
-        T sum = std::accumulate(values.begin(), values.end(), 0);
-        return (sum / (double)values.size());
+        return std::make_shared<const std::vector<StatLinePoint>>(std::move(rows));
     }
 
-    template<typename T>
-    double get_interquartile_average(const std::vector<T>& values)
-    {
-        int count = values.size();
+    // Defer a derived serie to the first time its legend entry is checked
+    void defer_serie(ExpHandle exp, uint8_t key, std::function<void()> build);
 
-        double first = find_median(values, 0, count / 2);
-        double third = find_median(values, count / 2 + (count % 2), count);
-        int n = 0;
+    // Build the deferred serie of key if it is shown, true if it was built
+    bool materialize(ExpHandle exp, uint8_t key);
 
-        T sum = std::accumulate(values.begin(), values.end(), 0, [first, third, &n](T acc, T v) {
-            if(v >= first && v <= third) {
-                n += 1;
-                return acc + v;
-            }
-            return acc;
+    // Interquartile mean and box of each row, built on demand
+    void defer_stat_line(ExpHandle exp, StatLineRows rows, uint8_t key_inter, uint8_t key_box)
+    {
+        defer_serie(exp, key_inter, [this, exp, key_inter, rows]() {
+            QList<QPointF> points;
+            points.reserve(rows->size());
+            for(const auto& row : *rows) points << QPointF(row.time, row.stats.interquartile_mean);
+
+            create_serie(exp, key_inter);
+            set_points(exp, key_inter, points);
+            add_serie(exp, key_inter);
         });
 
-        return (sum / (double)n);
+        defer_serie(exp, key_box, [this, exp, key_box, rows]() {
+            Staged staged;
+            for(const auto& row : *rows) staged.add_box(key_box, QString::number(row.time), row.stats);
+
+            create_serie<QBoxPlotSeries>(exp, key_box);
+            attach_points(exp, staged);
+            // add_serie<QBoxPlotSeries>(exp, key_box);
+        });
     }
 
     template<typename Serie = QLineSeries>
-    void add_serie(const QString& path, uint8_t key, QAbstractAxis* x_axis = nullptr, QAbstractAxis* y_axis = nullptr)
+    void add_serie(ExpHandle exp, uint8_t key, QAbstractAxis* x_axis = nullptr, QAbstractAxis* y_axis = nullptr)
     {
-        const auto& map = _path_keys[path];
-        const auto& [_, serie, chart, info, show] = map[key];
-
-        /*const auto& tuple = map[key];
-        auto* serie = static_cast<Serie*>(std::get<StatsKeyProperty::SERIE>(tuple));
-        auto* chart = std::get<StatsKeyProperty::CHART>(tuple);
-        auto show = std::get<StatsKeyProperty::SHOW>(tuple);*/
+        const auto& [_, serie, chart, info, show] = (*exp)[key];
 
         if(chart && serie) {
+            // animating the appearance of large series costs more than
+            // drawing them
+            auto animations = chart->animationOptions();
+            chart->setAnimationOptions(QChart::NoAnimation);
             chart->addSeries(serie);
+            chart->setAnimationOptions(animations);
 
             if(!show) serie->hide();
 
@@ -190,62 +299,86 @@ protected:
     }
 
     template<typename Serie=QLineSeries>
-    Serie* create_serie(const fs::path&p, uint8_t key)
+    Serie* create_serie(ExpHandle exp, uint8_t key)
     {
         auto serie = new Serie;
 
         QString name;
         QTextStream stream(&name);
 
-        std::stringstream exp_name(p.filename().string());
-
-        StatMap& map = _path_keys[p.c_str()];
-        if(map.empty()) {
-            init_map(map);
-            set_info(p);
-        }
-
-        // stream << std::get<StatsKeyProperty::NAME>(map[key]);
+        auto& slot = (*exp)[key];
 
-        auto info = std::get<StatsKeyProperty::INFO>(map[key]);
-        if(_display_impl && info.editable) {
-            stream << info.impl_str << " " << (info.stream ? info.cc_str : "dgrams");
+        if(_display_impl && slot.info.editable) {
+            stream << slot.info.impl_str << " " << (slot.info.stream ? slot.info.cc_str : "dgrams");
             serie->setName(name);
         }
         else {
-            stream << std::get<StatsKeyProperty::NAME>(map[key]);
+            stream << slot.name;
             serie->setName(name);
         }
 
-        std::get<StatsKeyProperty::SERIE>(map[key]) = serie;
-
-        const auto& legend = _path_keys["legend"];
-        std::get<StatsKeyProperty::SHOW>(map[key]) = std::get<StatsKeyProperty::SHOW>(legend[key]);
+        slot.serie = serie;
+        slot.show = _legend_slots[key].show;
 
         return serie;
     }
 
     QColor get_color(const ExpInfo& info);
 
-    static ExpInfo get_info(const fs::path& p);
+    static ExpInfo get_info(const ExperimentCatalog::Experiment& tags);
+
+    // One child of root per percentile, "<name> p50" and so on, none
+    // before they are selected
+    static void add_percentiles(QTreeWidgetItem* root, const QString& name, const Percentiles& percentiles);
 
     void create_legend();
     StatsLineChart * create_chart();
     StatsLineChartView * create_chart_view(QChart* chart);
     // void create_serie(const fs::path&p, uint8_t key);
 
-    virtual void init_map(StatMap& map, bool signal = true) = 0;
+    virtual void init_map(Experiment& exp) = 0;
+
+    // Pens of the series of experiment p
+    virtual void set_makeup(const fs::path& p) {}
+
+    int _batch = 0;
 
-    void set_info(const fs::path& path);
+    // Chart legends and axes for the series currently attached
+    virtual void refresh_charts() {}
+
+    // After attaching an experiment, deferred to end_batch inside a batch
+    void update_charts() { if(_batch == 0) refresh_all(); }
+
+    // refresh_charts on the whole series, then follow the new x axes
+    void refresh_all();
 
 public:
     bool _display_impl = true;
 
     DisplayBase(QWidget* tab, QListWidget* legend, QTreeWidget* info);
 
+    // Work left to the GUI thread once the files of an experiment are parsed
+    using Attach = std::function<void()>;
+
     virtual void load(const fs::path& path) = 0;
     virtual void unload(const fs::path& path);
 
+    // Background stage of load : read the files of experiment p and return
+    // what adds them to the charts, nothing if stop was requested meanwhile.
+    // Safe to call from any thread, the widgets and _experiments are only
+    // touched by the returned function. By default the whole load is left
+    // to the GUI thread.
+    virtual Attach parse(const fs::path& p, const ExperimentCatalog* catalog, std::stop_token stop = {})
+    {
+        return [this, p]() { load(p); };
+    }
+
+    void set_catalog(std::shared_ptr<const ExperimentCatalog> catalog) { _catalog = std::move(catalog); }
+
+    // Experiments attached between the two refresh the charts only once
+    void begin_batch() { ++_batch; }
+    void end_batch() { if(--_batch == 0) refresh_all(); }
+
     virtual void save(const fs::path& dir) = 0;
 };
 
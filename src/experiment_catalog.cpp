@@ -0,0 +1,313 @@
+#include "experiment_catalog.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+
+#include "column_cache.h"
+
+namespace
+{
+
+constexpr std::string_view HEADER = "stats_viewer catalog 2";
+
+fs::path normalized(const fs::path& p)
+{
+    auto n = p.lexically_normal();
+
+    // "results/" and "results" are the same directory
+    if(!n.has_filename() && n.has_relative_path()) n = n.parent_path();
+
+    return n;
+}
+
+int64_t mtime_of(const fs::path& p, std::error_code& ec)
+{
+    return fs::last_write_time(p, ec).time_since_epoch().count();
+}
+
+bool is_within(const fs::path& p, const fs::path& dir)
+{
+    auto [it, _] = std::mismatch(dir.begin(), dir.end(), p.begin(), p.end());
+    return it == dir.end();
+}
+
+std::vector<std::string_view> split(std::string_view line, char delimiter)
+{
+    std::vector<std::string_view> fields;
+
+    while(true) {
+        auto pos = line.find(delimiter);
+        fields.push_back(line.substr(0, pos));
+
+        if(pos == std::string_view::npos) break;
+        line.remove_prefix(pos + 1);
+    }
+
+    return fields;
+}
+
+template<typename T>
+bool parse_number(std::string_view field, T& value)
+{
+    auto [ptr, ec] = std::from_chars(field.data(), field.data() + field.size(), value);
+    return ec == std::errc{} && ptr == field.data() + field.size();
+}
+
+}
+
+ExperimentCatalog::ExperimentCatalog(const fs::path& root) : _root(normalized(root))
+{}
+
+std::optional<fs::path> ExperimentCatalog::relative(const fs::path& dir) const
+{
+    auto rel = normalized(dir).lexically_relative(_root);
+
+    if(rel.empty() || *rel.begin() == "..") return std::nullopt;
+    if(rel == ".") return fs::path{};
+
+    return rel;
+}
+
+ExperimentCatalog::Experiment ExperimentCatalog::tags_of(const fs::path& p)
+{
+    Experiment exp;
+
+    for(const auto& it : p) {
+        auto name = it.string();
+
+        if(name == "streams" || name == "stream") exp.stream = true;
+        else if(name == "dgrams" || name == "dgram") exp.stream = false;
+        else if(name == "mvfst" || name == "quicgo" || name == "quiche" || name == "msquic" || name == "udp") exp.impl = name;
+        else if(name == "bbr" || name == "newreno" || name == "none" || name == "copa" || name == "cubic") exp.cc = name;
+    }
+
+    return exp;
+}
+
+const ExperimentCatalog::Experiment* ExperimentCatalog::find(const fs::path& dir) const
+{
+    auto rel = relative(dir);
+    if(!rel) return nullptr;
+
+    auto it = _entries.find(*rel);
+    return (it != _entries.end()) ? &it->second : nullptr;
+}
+
+std::vector<fs::path> ExperimentCatalog::children(const fs::path& rel) const
+{
+    std::vector<fs::path> result;
+
+    auto it = _entries.upper_bound(rel);
+    while(it != _entries.end() && is_within(it->first, rel)) {
+        const fs::path& child = it->first;
+        result.push_back(child);
+
+        // "b\x01" sorts after every "b/..." and before any other sibling
+        it = _entries.lower_bound(child.parent_path() / (child.filename().string() + '\x01'));
+    }
+
+    return result;
+}
+
+bool ExperimentCatalog::has_children(const fs::path& rel) const
+{
+    auto it = _entries.upper_bound(rel);
+    return it != _entries.end() && is_within(it->first, rel);
+}
+
+fs::path ExperimentCatalog::find_file(const fs::path& dir, const std::function<bool(const fs::path&)>& match) const
+{
+    auto rel = relative(dir);
+    if(!rel) return {};
+
+    for(auto it = _entries.lower_bound(*rel); it != _entries.end() && is_within(it->first, *rel); ++it) {
+        fs::path base = it->first.empty() ? _root : _root / it->first;
+
+        for(const auto& file : it->second.files) {
+            fs::path path = base / file.name;
+            if(match(path)) return path;
+        }
+    }
+
+    return {};
+}
+
+ExperimentCatalog ExperimentCatalog::scan(const fs::path& root)
+{
+    return *ExperimentCatalog(root).reconcile();
+}
+
+std::optional<ExperimentCatalog> ExperimentCatalog::reconcile(std::stop_token stop) const
+{
+    ExperimentCatalog updated;
+    updated._root = _root;
+
+    // direct subdirectories of the catalogued directories
+    std::map<fs::path, std::vector<fs::path>> subdirs;
+    for(const auto& [rel, exp] : _entries) {
+        if(!rel.empty()) subdirs[rel.parent_path()].push_back(rel);
+    }
+
+    std::vector<fs::path> pending{ fs::path{} };
+
+    while(!pending.empty()) {
+        if(stop.stop_requested()) return std::nullopt;
+
+        fs::path rel = std::move(pending.back());
+        pending.pop_back();
+
+        fs::path dir = rel.empty() ? _root : _root / rel;
+
+        std::error_code ec;
+        int64_t mtime = mtime_of(dir, ec);
+        if(ec) continue;
+
+        // adding or removing an entry changes the mtime of the directory
+        auto known = _entries.find(rel);
+        if(known != _entries.end() && known->second.mtime == mtime) {
+            updated._entries.emplace(rel, known->second);
+
+            auto it = subdirs.find(rel);
+            if(it != subdirs.end()) pending.insert(pending.end(), it->second.begin(), it->second.end());
+
+            continue;
+        }
+
+        Experiment exp = tags_of(dir);
+        exp.mtime = mtime;
+
+        fs::directory_iterator it(dir, ec);
+        for(; !ec && it != fs::directory_iterator(); it.increment(ec)) {
+            auto name = it->path().filename().string();
+            if(name.starts_with(".")) continue;
+
+            std::error_code entry_ec;
+
+            // symlinked directories are listed but not followed
+            if(it->is_directory(entry_ec)) {
+                if(!it->is_symlink(entry_ec)) pending.push_back(rel / name);
+                continue;
+            }
+
+            if(!it->is_regular_file(entry_ec)) continue;
+
+            DataFile file{ name, it->file_size(entry_ec), 0 };
+            file.mtime = mtime_of(it->path(), entry_ec);
+
+            exp.files.push_back(std::move(file));
+        }
+
+        std::sort(exp.files.begin(), exp.files.end(), [](const auto& a, const auto& b) { return a.name < b.name; });
+        updated._entries.emplace(rel, std::move(exp));
+    }
+
+    return updated;
+}
+
+fs::path ExperimentCatalog::catalog_path(const fs::path& root)
+{
+    const char* dir = std::getenv("STATS_VIEWER_CACHE_DIR");
+    if(dir == nullptr || *dir == '\0') return normalized(root) / ".catalog";
+
+    std::error_code ec;
+    auto absolute = fs::absolute(normalized(root), ec).string();
+
+    std::ostringstream key;
+    key << std::hex << column_cache::schema_id(absolute);
+
+    return fs::path(dir) / (key.str() + ".catalog");
+}
+
+std::optional<ExperimentCatalog> ExperimentCatalog::load(const fs::path& root)
+{
+    std::ifstream ifs(catalog_path(root));
+    if(!ifs.is_open()) return std::nullopt;
+
+    std::string line;
+    if(!std::getline(ifs, line) || line != HEADER) return std::nullopt;
+
+    ExperimentCatalog catalog(root);
+    Experiment* current = nullptr;
+
+    while(std::getline(ifs, line)) {
+        auto fields = split(line, '\t');
+
+        if(fields[0] == "D" && fields.size() == 6) {
+            Experiment exp;
+            if(!parse_number(fields[2], exp.mtime)) return std::nullopt;
+
+            exp.impl = fields[3];
+            exp.cc = fields[4];
+            exp.stream = (fields[5] == "1");
+
+            current = &catalog._entries[fs::path(fields[1])];
+            *current = std::move(exp);
+        }
+        else if(fields[0] == "F" && fields.size() == 4 && current) {
+            DataFile file{ std::string(fields[1]) };
+            if(!parse_number(fields[2], file.size) || !parse_number(fields[3], file.mtime)) return std::nullopt;
+
+            current->files.push_back(std::move(file));
+        }
+        else {
+            return std::nullopt;
+        }
+    }
+
+    return catalog;
+}
+
+bool ExperimentCatalog::save() const
+{
+    fs::path path = catalog_path(_root);
+    fs::path tmp = path;
+    tmp += ".tmp";
+
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+
+    {
+        std::ofstream ofs(tmp, std::ios::trunc);
+        if(!ofs.is_open()) return false;
+
+        ofs << HEADER << '\n';
+
+        for(const auto& [rel, exp] : _entries) {
+            ofs << "D\t" << rel.string() << '\t' << exp.mtime << '\t' << exp.impl << '\t' << exp.cc << '\t' << exp.stream << '\n';
+
+            for(const auto& file : exp.files) {
+                ofs << "F\t" << file.name << '\t' << file.size << '\t' << file.mtime << '\n';
+            }
+        }
+
+        if(!ofs) {
+            ofs.close();
+            fs::remove(tmp, ec);
+            return false;
+        }
+    }
+
+    fs::rename(tmp, path, ec);
+    if(ec) fs::remove(tmp, ec);
+
+    return !ec;
+}
+
+fs::path find_data_file(const ExperimentCatalog* catalog, const fs::path& dir, const std::function<bool(const fs::path&)>& match)
+{
+    // a file added since the catalog was loaded is still found by the walk
+    if(catalog && catalog->find(dir)) {
+        fs::path found = catalog->find_file(dir, match);
+        if(!found.empty()) return found;
+    }
+
+    for (auto const& dir_entry : fs::recursive_directory_iterator{dir}) {
+        if(dir_entry.is_regular_file() && match(dir_entry.path())) return dir_entry.path();
+    }
+
+    return {};
+}
@@ -0,0 +1,100 @@
+#ifndef EXPERIMENT_CATALOG_H
+#define EXPERIMENT_CATALOG_H
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// On-disk index of a results tree: every directory with the impl, cc and
+// stream/dgram tags of its path and the data files it holds.
+//
+// It is loaded at startup instead of walking the tree, then reconciled in
+// the background : directories whose mtime did not change are not listed
+// again, so only new or modified runs cost a readdir.
+class ExperimentCatalog
+{
+public:
+    struct DataFile
+    {
+        std::string name;
+        uint64_t size = 0;
+        int64_t mtime = 0;
+
+        bool operator==(const DataFile&) const = default;
+    };
+
+    struct Experiment
+    {
+        int64_t mtime = 0;  // of the directory
+
+        std::string impl;
+        std::string cc;
+        bool stream = true;
+
+        std::vector<DataFile> files;  // regular files, hidden ones excluded
+
+        bool operator==(const Experiment&) const = default;
+    };
+
+    // Directories relative to the root, sorted so that the subdirectories of
+    // a directory directly follow it. The root itself is the empty path.
+    using Entries = std::map<fs::path, Experiment>;
+
+private:
+    fs::path _root;
+    Entries _entries;
+
+    // Path of dir relative to the root, nullopt if outside of it
+    std::optional<fs::path> relative(const fs::path& dir) const;
+
+public:
+    ExperimentCatalog() = default;
+    explicit ExperimentCatalog(const fs::path& root);
+
+    const fs::path& root() const { return _root; }
+    const Entries& entries() const { return _entries; }
+
+    // nullptr if dir is not below the root or not catalogued
+    const Experiment* find(const fs::path& dir) const;
+
+    // impl, cc and stream named by the components of a path, without files
+    static Experiment tags_of(const fs::path& p);
+
+    // Direct subdirectories of a directory given relative to the root, in
+    // catalog order. Subtrees are skipped, not walked.
+    std::vector<fs::path> children(const fs::path& rel) const;
+    bool has_children(const fs::path& rel) const;
+
+    // First file of dir or of one of its subdirectories accepted by match,
+    // empty path if none
+    fs::path find_file(const fs::path& dir, const std::function<bool(const fs::path&)>& match) const;
+
+    // Full walk of the tree
+    static ExperimentCatalog scan(const fs::path& root);
+
+    // Catalog saved for root, nullopt if missing or unreadable
+    static std::optional<ExperimentCatalog> load(const fs::path& root);
+    bool save() const;
+
+    // Catalog of the tree as it is now, reusing the entries of unchanged
+    // directories. Files modified in place do not change the mtime of their
+    // directory and keep their previous size. nullopt when stop is requested
+    // before the end.
+    std::optional<ExperimentCatalog> reconcile(std::stop_token stop = {}) const;
+
+    // ".catalog" at the root, or in $STATS_VIEWER_CACHE_DIR when set
+    static fs::path catalog_path(const fs::path& root);
+};
+
+// Resolve a file through catalog when it knows dir, by walking dir when it
+// does not or when the file is not catalogued yet
+fs::path find_data_file(const ExperimentCatalog* catalog, const fs::path& dir, const std::function<bool(const fs::path&)>& match);
+
+#endif // EXPERIMENT_CATALOG_H
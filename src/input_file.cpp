@@ -0,0 +1,308 @@
+#include "input_file.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <stdexcept>
+
+#include <zlib.h>
+#include <zstd.h>
+
+Compression compression_of(const fs::path& p)
+{
+    auto ext = p.extension();
+
+    if(ext == ".gz") return Compression::GZIP;
+    if(ext == ".zst") return Compression::ZSTD;
+
+    return Compression::NONE;
+}
+
+fs::path strip_compression(const fs::path& p)
+{
+    if(compression_of(p) == Compression::NONE) return p;
+
+    auto stripped = p;
+    stripped.replace_extension();
+
+    return stripped;
+}
+
+fs::path find_input(const fs::path& p)
+{
+    if(fs::exists(p)) return p;
+
+    for(const char* ext : { ".gz", ".zst" }) {
+        fs::path compressed = p;
+        compressed += ext;
+
+        if(fs::exists(compressed)) return compressed;
+    }
+
+    return p;
+}
+
+namespace
+{
+
+class PlainBlockReader : public BlockReader
+{
+    FILE* _file;
+    std::vector<char> _block;
+
+public:
+    explicit PlainBlockReader(FILE* file) : _file(file), _block(BLOCK_SIZE) {}
+    ~PlainBlockReader() override { std::fclose(_file); }
+
+    std::string_view next() override
+    {
+        size_t n = std::fread(_block.data(), 1, _block.size(), _file);
+        return { _block.data(), n };
+    }
+};
+
+class GzipBlockReader : public BlockReader
+{
+    gzFile _file;
+    std::vector<char> _block;
+
+public:
+    explicit GzipBlockReader(gzFile file) : _file(file), _block(BLOCK_SIZE)
+    {
+        gzbuffer(_file, BLOCK_SIZE);
+    }
+
+    ~GzipBlockReader() override { gzclose(_file); }
+
+    std::string_view next() override
+    {
+        int n = gzread(_file, _block.data(), static_cast<unsigned>(_block.size()));
+        if(n < 0) throw std::runtime_error("Corrupted gzip stream");
+
+        return { _block.data(), static_cast<size_t>(n) };
+    }
+};
+
+class ZstdBlockReader : public BlockReader
+{
+    FILE* _file;
+    ZSTD_DStream* _stream;
+    std::vector<char> _in;
+    std::vector<char> _block;
+    ZSTD_inBuffer _input{ nullptr, 0, 0 };
+    bool _eof = false;
+    bool _complete = true;  // no frame started but not fully decoded
+
+public:
+    explicit ZstdBlockReader(FILE* file)
+        : _file(file), _stream(ZSTD_createDStream()), _in(ZSTD_DStreamInSize()), _block(BLOCK_SIZE)
+    {
+        ZSTD_initDStream(_stream);
+    }
+
+    ~ZstdBlockReader() override
+    {
+        ZSTD_freeDStream(_stream);
+        std::fclose(_file);
+    }
+
+    std::string_view next() override
+    {
+        ZSTD_outBuffer output{ _block.data(), _block.size(), 0 };
+
+        while(output.pos < output.size) {
+            if(_input.pos == _input.size && !_eof) {
+                size_t n = std::fread(_in.data(), 1, _in.size(), _file);
+
+                if(n == 0) _eof = true;
+                else _input = ZSTD_inBuffer{ _in.data(), n, 0 };
+            }
+
+            // once the input runs out, zstd may still hold decoded bytes
+            // that did not fit in the previous block
+            size_t consumed = _input.pos;
+            size_t produced = output.pos;
+
+            size_t ret = ZSTD_decompressStream(_stream, &output, &_input);
+            if(ZSTD_isError(ret)) {
+                throw std::runtime_error(std::string("Corrupted zstd stream : ") + ZSTD_getErrorName(ret));
+            }
+
+            // without progress the return is only the size hint of the next
+            // frame header, 0 means the current frame is complete
+            bool progress = _input.pos != consumed || output.pos != produced;
+            if(progress) _complete = (ret == 0);
+
+            if(_eof && !progress) {
+                if(!_complete) throw std::runtime_error("Truncated zstd stream");
+                break;
+            }
+        }
+
+        return { _block.data(), output.pos };
+    }
+};
+
+// Decompressed size written in the file, 0 when it is not
+size_t announced_size(const fs::path& p, Compression compression)
+{
+    FILE* file = std::fopen(p.c_str(), "rb");
+    if(!file) return 0;
+
+    size_t size = 0;
+
+    if(compression == Compression::GZIP) {
+        // ISIZE of the trailer, wrapped for contents over 4 GB and only
+        // the last member of concatenated ones
+        std::array<unsigned char, 4> trailer;
+        if(std::fseek(file, -4, SEEK_END) == 0 && std::fread(trailer.data(), 1, trailer.size(), file) == trailer.size()) {
+            size = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | (static_cast<size_t>(trailer[3]) << 24);
+
+            long compressed = std::ftell(file);
+            if(compressed > 0 && size < static_cast<size_t>(compressed)) size = 0;
+        }
+    }
+    else if(compression == Compression::ZSTD) {
+        // ZSTD_FRAMEHEADERSIZE_MAX, only exposed by the static API
+        std::array<char, 18> header;
+        size_t n = std::fread(header.data(), 1, header.size(), file);
+
+        unsigned long long content = ZSTD_getFrameContentSize(header.data(), n);
+        if(content != ZSTD_CONTENTSIZE_UNKNOWN && content != ZSTD_CONTENTSIZE_ERROR) size = content;
+    }
+
+    std::fclose(file);
+    return size;
+}
+
+}
+
+std::unique_ptr<BlockReader> BlockReader::open(const fs::path& p)
+{
+    std::unique_ptr<BlockReader> reader;
+
+    switch(compression_of(p)) {
+    case Compression::GZIP: {
+        gzFile file = gzopen(p.c_str(), "rb");
+        if(!file) return nullptr;
+
+        reader = std::make_unique<GzipBlockReader>(file);
+        break;
+    }
+    case Compression::ZSTD: {
+        FILE* file = std::fopen(p.c_str(), "rb");
+        if(!file) return nullptr;
+
+        reader = std::make_unique<ZstdBlockReader>(file);
+        break;
+    }
+    case Compression::NONE: {
+        FILE* file = std::fopen(p.c_str(), "rb");
+        if(!file) return nullptr;
+
+        std::error_code ec;
+        auto size = fs::file_size(p, ec);
+
+        reader = std::make_unique<PlainBlockReader>(file);
+        reader->_content_size = ec ? 0 : size;
+        return reader;
+    }
+    }
+
+    reader->_content_size = announced_size(p, compression_of(p));
+    return reader;
+}
+
+LineSource::LineSource(const fs::path& p)
+{
+    if(compression_of(p) == Compression::NONE) {
+        _file = std::make_unique<MappedFile>(p);
+        return;
+    }
+
+    _reader = BlockReader::open(p);
+    if(!_reader) {
+        throw std::runtime_error("Could not open file with provided path : " + p.string());
+    }
+}
+
+size_t LineSource::size_hint() const
+{
+    return _file ? _file->size() : _reader->content_size();
+}
+
+std::string_view LineSource::next()
+{
+    if(_file) {
+        if(_done) return {};
+
+        _done = true;
+        return _file->view();
+    }
+
+    // keep the partial last line of the previous window
+    _buffer.erase(0, _consumed);
+
+    while(true) {
+        auto block = _reader->next();
+
+        if(block.empty()) {
+            // end of stream, hand out the last line even without newline
+            _consumed = _buffer.size();
+            return _buffer;
+        }
+
+        size_t searched = _buffer.size();
+        _buffer.append(block);
+
+        auto nl = std::string_view(_buffer).substr(searched).rfind('\n');
+        if(nl != std::string_view::npos) {
+            _consumed = searched + nl + 1;
+            return std::string_view(_buffer).substr(0, _consumed);
+        }
+    }
+}
+
+std::vector<std::string_view> split_lines(std::string_view data, size_t n)
+{
+    std::vector<std::string_view> ranges;
+    size_t begin = 0;
+
+    for(size_t i = 1; i <= n && begin < data.size(); ++i) {
+        size_t end = (i == n) ? data.size() : std::max(begin, data.size() * i / n);
+
+        end = data.find('\n', end);
+        end = (end == std::string_view::npos) ? data.size() : end + 1;
+
+        ranges.push_back(data.substr(begin, end - begin));
+        begin = end;
+    }
+
+    return ranges;
+}
+
+BlockStreamBuf::int_type BlockStreamBuf::underflow()
+{
+    if(gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+    _block = _reader->next();
+    if(_block.empty()) return traits_type::eof();
+
+    // the stream only reads, the buffer is never written through
+    char* begin = const_cast<char*>(_block.data());
+    setg(begin, begin, begin + _block.size());
+
+    return traits_type::to_int_type(*gptr());
+}
+
+InputStream::InputStream(const fs::path& p) : std::istream(nullptr)
+{
+    auto reader = BlockReader::open(p);
+    if(!reader) {
+        setstate(std::ios::failbit);
+        return;
+    }
+
+    _buf = std::make_unique<BlockStreamBuf>(std::move(reader));
+    rdbuf(_buf.get());
+}
@@ -0,0 +1,128 @@
+#ifndef INPUT_FILE_H
+#define INPUT_FILE_H
+
+#include <filesystem>
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mapped_file.h"
+
+namespace fs = std::filesystem;
+
+// Result files may be archived as gzip (.gz) or zstd (.zst). Everything
+// reading them goes through this header so they are decompressed on the
+// fly, block by block, without temporary files.
+
+enum class Compression
+{
+    NONE,
+    GZIP,
+    ZSTD
+};
+
+Compression compression_of(const fs::path& p);
+
+// "medooze.csv.gz" -> "medooze.csv", uncompressed paths are returned as is
+fs::path strip_compression(const fs::path& p);
+
+// p if it exists, else its first existing compressed variant. Returns p
+// when none exists so that callers report the plain name.
+fs::path find_input(const fs::path& p);
+
+// Sequential reader handing out the decompressed content in fixed size
+// blocks. Plain files are read as is.
+class BlockReader
+{
+public:
+    static constexpr size_t BLOCK_SIZE = 1 << 20;
+
+    virtual ~BlockReader() = default;
+
+    // Next block, empty once the end of the stream is reached. The view is
+    // valid until the next call.
+    virtual std::string_view next() = 0;
+
+    // Size of the decompressed content as announced by the file, 0 when
+    // it does not tell. Only a hint, a gzip trailer is the size modulo 2^32.
+    size_t content_size() const { return _content_size; }
+
+    // nullptr when the file can not be opened
+    static std::unique_ptr<BlockReader> open(const fs::path& p);
+
+private:
+    size_t _content_size = 0;
+};
+
+// Whole file as consecutive windows of complete lines. Plain files are
+// memory mapped and come as a single window, compressed ones are streamed.
+class LineSource
+{
+    std::unique_ptr<MappedFile> _file;
+    std::unique_ptr<BlockReader> _reader;
+    std::string _buffer;
+    size_t _consumed = 0;
+    bool _done = false;
+
+public:
+    explicit LineSource(const fs::path& p);
+
+    // Next window, empty at the end of the file. The view is valid until
+    // the next call.
+    std::string_view next();
+
+    // Mapping of an uncompressed file, nullptr for compressed ones
+    const MappedFile* mapped() const { return _file.get(); }
+
+    // Expected size of the whole content, 0 when unknown
+    size_t size_hint() const;
+};
+
+// Call f with every line of a file, without the newline. Lines are views
+// into the current window and are only valid during the call.
+template<typename F>
+void for_each_line(const fs::path& p, F&& f)
+{
+    LineSource source(p);
+
+    for(auto window = source.next(); !window.empty(); window = source.next()) {
+        while(!window.empty()) {
+            auto eol = window.find('\n');
+            f(window.substr(0, eol));
+
+            window.remove_prefix(eol == std::string_view::npos ? window.size() : eol + 1);
+        }
+    }
+}
+
+// Split a buffer in at most n ranges, every range but the first starts
+// right after a newline
+std::vector<std::string_view> split_lines(std::string_view data, size_t n);
+
+class BlockStreamBuf : public std::streambuf
+{
+    std::unique_ptr<BlockReader> _reader;
+    std::string_view _block;
+
+protected:
+    int_type underflow() override;
+
+public:
+    explicit BlockStreamBuf(std::unique_ptr<BlockReader> reader) : _reader(std::move(reader)) {}
+};
+
+// std::istream over a plain or compressed file, used like an ifstream
+class InputStream : public std::istream
+{
+    std::unique_ptr<BlockStreamBuf> _buf;
+
+public:
+    explicit InputStream(const fs::path& p);
+
+    bool is_open() const { return _buf != nullptr; }
+};
+
+#endif // INPUT_FILE_H
@@ -0,0 +1,197 @@
+#include "lod.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace lod
+{
+
+bool TimeColumn::same_as(const QList<QPointF>& points) const
+{
+    if(static_cast<size_t>(points.size()) != x.size()) return false;
+
+    for(size_t i = 0; i < x.size(); ++i) {
+        if(x[i] != static_cast<float>(points[i].x() - origin)) return false;
+    }
+
+    return true;
+}
+
+Pyramid::Pyramid(const QList<QPointF>& points, std::shared_ptr<const TimeColumn> time) : _time(std::move(time))
+{
+    if(!_time || !_time->same_as(points)) {
+        auto column = std::make_shared<TimeColumn>();
+        column->origin = points.empty() ? 0. : points.front().x();
+
+        column->x.reserve(points.size());
+        for(const auto& p : points) column->x.push_back(p.x() - column->origin);
+
+        _time = std::move(column);
+    }
+
+    _y.reserve(points.size());
+    for(const auto& p : points) _y.push_back(p.y());
+
+    constexpr size_t width = size_t{1} << FINEST_LEVEL;
+    if(_y.size() <= width) return;
+
+    std::vector<Bin> finest;
+    finest.reserve(_y.size() / width + 1);
+
+    for(size_t begin = 0; begin < _y.size(); begin += width) {
+        size_t end = std::min(begin + width, _y.size());
+
+        Bin bin{ static_cast<uint32_t>(begin), static_cast<uint32_t>(begin) };
+        for(size_t i = begin; i < end; ++i) {
+            if(_y[i] < _y[bin.min]) bin.min = i;
+            if(_y[i] > _y[bin.max]) bin.max = i;
+        }
+
+        finest.push_back(bin);
+    }
+
+    _levels.push_back(std::move(finest));
+
+    auto merged = [this](const Bin& a, const Bin& b) {
+        return Bin{ (_y[b.min] < _y[a.min]) ? b.min : a.min, (_y[b.max] > _y[a.max]) ? b.max : a.max };
+    };
+
+    // up to a level that fits in a few columns
+    while(_levels.back().size() > 64) {
+        const auto& below = _levels.back();
+
+        std::vector<Bin> level;
+        level.reserve(below.size() / 2 + 1);
+
+        for(size_t i = 0; i < below.size(); i += 2) {
+            level.push_back((i + 1 < below.size()) ? merged(below[i], below[i + 1]) : below[i]);
+        }
+
+        _levels.push_back(std::move(level));
+    }
+}
+
+QList<QPointF> Pyramid::points() const
+{
+    QList<QPointF> result;
+    result.reserve(size());
+
+    for(size_t i = 0; i < size(); ++i) result << point(i);
+
+    return result;
+}
+
+void Pyramid::append_extrema(QList<QPointF>& result, size_t low, size_t high) const
+{
+    // in x order, the line must not go back
+    if(low == high) result << point(low);
+    else if(low < high) result << point(low) << point(high);
+    else result << point(high) << point(low);
+}
+
+std::pair<size_t, size_t> Pyramid::extrema(size_t begin, size_t end) const
+{
+    size_t low = begin, high = begin;
+
+    auto point = [&](size_t i) {
+        if(_y[i] < _y[low]) low = i;
+        if(_y[i] > _y[high]) high = i;
+    };
+
+    auto bin = [&](const Bin& b) {
+        if(_y[b.min] < _y[low]) low = b.min;
+        if(_y[b.max] > _y[high]) high = b.max;
+    };
+
+    // points outside of the finest bins
+    constexpr size_t width = size_t{1} << FINEST_LEVEL;
+
+    if(_levels.empty() || end - begin < 2 * width) {
+        for(size_t i = begin; i < end; ++i) point(i);
+        return { low, high };
+    }
+
+    for(; begin < end && (begin & (width - 1)); ++begin) point(begin);
+    for(; end > begin && (end & (width - 1)); --end) point(end - 1);
+
+    // whole bins, the odd one on each side then up a level
+    size_t first = begin >> FINEST_LEVEL, last = end >> FINEST_LEVEL;
+
+    for(size_t level = 0; first < last; ++level, first >>= 1, last >>= 1) {
+        const auto& bins = _levels[level];
+
+        if(level + 1 == _levels.size()) {
+            for(size_t i = first; i < last; ++i) bin(bins[i]);
+            break;
+        }
+
+        if(first & 1) bin(bins[first++]);
+        if(last & 1) bin(bins[--last]);
+    }
+
+    return { low, high };
+}
+
+QList<QPointF> Pyramid::query(double x_min, double x_max, size_t columns) const
+{
+    const auto& x = _time->x;
+
+    size_t begin = std::lower_bound(x.begin(), x.end(), x_min - _time->origin, [](float a, double b) { return a < b; }) - x.begin();
+    size_t end = std::upper_bound(x.begin() + begin, x.end(), x_max - _time->origin, [](double b, float a) { return b < a; }) - x.begin();
+
+    size_t first = (begin > 0) ? begin - 1 : begin;
+    size_t last = std::min(end + 1, size());
+
+    QList<QPointF> result;
+
+    if(columns == 0 || x_max <= x_min || end - begin <= 2 * columns) {
+        result.reserve(last - first);
+        for(size_t i = first; i < last; ++i) result << point(i);
+        return result;
+    }
+
+    result.reserve(2 * columns + 2);
+
+    if(first != begin) result << point(first);
+
+    double from = x_min - _time->origin;
+    double scale = columns / (x_max - x_min);
+
+    // one column after the other, the empty ones are skipped
+    for(size_t i = begin; i < end;) {
+        auto column = static_cast<size_t>(std::clamp((x[i] - from) * scale, 0., columns - 1.));
+        double edge = from + (column + 1) / scale;
+
+        size_t next = (column + 1 == columns) ? end
+            : std::lower_bound(x.begin() + i, x.begin() + end, edge, [](float a, double b) { return a < b; }) - x.begin();
+        next = std::max(next, i + 1);
+
+        auto [low, high] = extrema(i, next);
+        append_extrema(result, low, high);
+
+        i = next;
+    }
+
+    if(last != end) result << point(end);
+
+    return result;
+}
+
+std::shared_ptr<const Pyramid> make_pyramid(const QList<QPointF>& points, std::shared_ptr<const TimeColumn> time)
+{
+    if(points.empty() || !std::ranges::is_sorted(points, {}, &QPointF::x)) return nullptr;
+    return std::make_shared<const Pyramid>(points, std::move(time));
+}
+
+size_t point_budget()
+{
+    static const size_t budget = []() -> size_t {
+        const char* value = std::getenv("STATS_VIEWER_POINT_BUDGET");
+        if(value && std::atoll(value) > 0) return std::atoll(value);
+        return 200000;
+    }();
+
+    return budget;
+}
+
+}
@@ -0,0 +1,97 @@
+#ifndef LOD_H
+#define LOD_H
+
+#include <QList>
+#include <QPointF>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Level of detail of the line series.
+//
+// A serie keeps all of its points but only hands the chart what can be
+// drawn of the visible x range : within each pixel column the lowest and
+// highest points, in x order. Peaks survive decimation, so the autoscaled
+// axes are the same as with the full data, and zooming in progressively
+// shows the points that were merged.
+//
+// The full resolution points are held as float columns, the chart itself
+// only ever gets the few points it draws.
+namespace lod
+{
+
+// x of the points of a serie, relative to the first one so that float keeps
+// sub-millisecond steps over hours. Series sampled at the same times share
+// it.
+struct TimeColumn
+{
+    double origin = 0.;
+    std::vector<float> x;
+
+    bool same_as(const QList<QPointF>& points) const;
+};
+
+// Lowest and highest point of a serie in bins of 2^k consecutive points,
+// for every k from FINEST_LEVEL up. Bins are counted in points, not in x,
+// so a query finds the points of each pixel column by their x first. Their
+// extrema then come from at most two bins per level, as in a segment
+// tree, plus the few points outside of the finest bins. A query costs
+// O(columns * log(points)) whatever the spacing of the points, dense
+// bursts are not flattened and sparse stretches are not oversampled.
+class Pyramid
+{
+public:
+    struct Bin
+    {
+        uint32_t min = 0, max = 0;  // indices of the lowest and highest point
+    };
+
+    static constexpr size_t FINEST_LEVEL = 3;
+
+    // points are sorted by x, their x are not stored again when time holds
+    // the same ones
+    explicit Pyramid(const QList<QPointF>& points, std::shared_ptr<const TimeColumn> time = {});
+
+    size_t size() const { return _y.size(); }
+    QPointF point(size_t i) const { return { _time->origin + _time->x[i], _y[i] }; }
+
+    // Copy of every point
+    QList<QPointF> points() const;
+
+    const std::shared_ptr<const TimeColumn>& time() const { return _time; }
+
+    // bins of 2^(FINEST_LEVEL + i) points
+    const std::vector<std::vector<Bin>>& levels() const { return _levels; }
+
+    // Points of [x_min, x_max] reduced to at most two per column, plus the
+    // neighbours just outside so that the line reaches the edges. All of
+    // them when they already fit.
+    QList<QPointF> query(double x_min, double x_max, size_t columns) const;
+
+private:
+    std::shared_ptr<const TimeColumn> _time;
+    std::vector<float> _y;
+    std::vector<std::vector<Bin>> _levels;
+
+    // lowest and highest point of [begin, end), in x order
+    void append_extrema(QList<QPointF>& result, size_t low, size_t high) const;
+
+    // indices of the lowest and highest point of [begin, end), not empty
+    std::pair<size_t, size_t> extrema(size_t begin, size_t end) const;
+};
+
+// nullptr if points are empty or not sorted by x. Safe to call from any
+// thread.
+std::shared_ptr<const Pyramid> make_pyramid(const QList<QPointF>& points, std::shared_ptr<const TimeColumn> time = {});
+
+// Points drawn at most by a display, shared by the visible series of its
+// charts.
+// $STATS_VIEWER_POINT_BUDGET when set.
+size_t point_budget();
+
+}
+
+#endif // LOD_H
@@ -1,17 +1,72 @@
 #include <QApplication>
+#include <algorithm>
 #include <iostream>
+#include <filesystem>
+#include <string_view>
 
+#include "experiment_catalog.h"
 #include "main_window.h"
+#include "thread_pool.h"
+
+namespace fs = std::filesystem;
+
+// Parse every experiment below root into its column cache, in parallel and
+// without any window, so that later GUI sessions only map the caches
+int warm_cache(const fs::path& root)
+{
+    // the catalog walk skips unreadable directories and does not follow
+    // symlinks, as for the GUI
+    auto catalog = ExperimentCatalog::scan(root);
+    std::vector<fs::path> experiments;
+
+    for(const auto& entry : catalog.entries()) {
+        const fs::path& rel = entry.first;
+        if(rel.empty()) continue;
+
+        // experiments are the leaves of the tree, as in MainWindow::on_exp_changed,
+        // average and everything below it are not runs
+        if(catalog.has_children(rel) || std::find(rel.begin(), rel.end(), "average") != rel.end()) continue;
+
+        experiments.push_back(root / rel);
+    }
+
+    auto& pool = ThreadPool::global();
+    std::vector<std::future<void>> pending;
+
+    for(const auto& exp : experiments) {
+        pending.push_back(pool.submit([exp]() {
+            for(auto* warm : { &ReceivedBitrateDisplay::warm_cache, &MedoozeDisplay::warm_cache, &QlogDisplay::warm_cache }) {
+                try {
+                    warm(exp);
+                }
+                catch(const std::exception& e) {
+                    std::cout << "Could not cache " << exp << " : " << e.what() << std::endl;
+                }
+            }
+        }));
+    }
+
+    pool.wait(pending);
+    for(auto& f : pending) f.get();
+
+    std::cout << "Cached " << experiments.size() << " experiments" << std::endl;
+    return EXIT_SUCCESS;
+}
 
 int main(int argc, char *argv[])
 {
+    if(argc == 3 && std::string_view(argv[1]) == "--warm-cache") {
+        return warm_cache(argv[2]);
+    }
+
     QApplication app(argc, argv);
 
     MainWindow window;
 
     if(argc < 2) {
         std::cout << "Error: missing results path argument" << "\n\n"
-                  << "Usage : " << argv[0] << " <path_to_result>"
+                  << "Usage : " << argv[0] << " <path_to_result>" << "\n"
+                  << "        " << argv[0] << " --warm-cache <path_to_result>"
                   << std::endl;
         return EXIT_FAILURE;
     }
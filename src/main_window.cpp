@@ -1,13 +1,38 @@
 #include "main_window.h"
 #include "ui_main_window.h"
 
+#include <cstdlib>
 #include <filesystem>
 
 #include <QStack>
-// #include <thread>
+#include <QSignalBlocker>
+#include <QProgressBar>
+
+#include <iostream>
+
+#include "thread_pool.h"
 
 namespace fs = std::filesystem;
 
+namespace
+{
+
+// set on the items whose children have been created
+constexpr int POPULATED_ROLE = Qt::UserRole;
+
+bool is_populated(const QTreeWidgetItem* item)
+{
+    return item->data(0, POPULATED_ROLE).toBool();
+}
+
+// children of unexpanded items are not created yet
+bool has_children(const QTreeWidgetItem* item)
+{
+    return item->childCount() > 0 || item->childIndicatorPolicy() == QTreeWidgetItem::ShowIndicator;
+}
+
+}
+
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
@@ -27,6 +52,11 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->action1_1, &QAction::triggered, this, &MainWindow::on_ratio_1_1);
     connect(ui->action2_1, &QAction::triggered, this, &MainWindow::on_ratio_2_1);
     connect(ui->acitionShowImpl, &QAction::triggered, this, &MainWindow::on_impl_show);
+
+    // each experiment keeps up to three pool threads busy
+    const char* max_loads = std::getenv("STATS_VIEWER_MAX_LOADS");
+    if(max_loads && std::atoi(max_loads) > 0) _max_loading = std::atoi(max_loads);
+    else _max_loading = std::max<int>(1, ThreadPool::global().size() / displays().size());
 }
 
 void MainWindow::keyPressEvent(QKeyEvent * event)
@@ -42,72 +72,182 @@ void MainWindow::set_stats_dir(std::string dir)
     _stats_dir = std::move(dir);
 }
 
+void MainWindow::set_catalog(std::shared_ptr<const ExperimentCatalog> catalog)
+{
+    _catalog = std::move(catalog);
+
+    _recv_display->set_catalog(_catalog);
+    _medooze_display->set_catalog(_catalog);
+    _qlog_display->set_catalog(_catalog);
+}
+
+std::array<DisplayBase*, 3> MainWindow::displays() const
+{
+    return { _recv_display.get(), _medooze_display.get(), _qlog_display.get() };
+}
+
+QTreeWidgetItem* MainWindow::add_exp_item(const fs::path& rel)
+{
+    QTreeWidgetItem * item = nullptr;
+
+    auto parent = _exp_items.value(rel.parent_path().c_str(), nullptr);
+
+    if(parent) item = new QTreeWidgetItem(parent);
+    else item = new QTreeWidgetItem(ui->exp_menu);
+
+    item->setFlags(Qt::ItemIsUserCheckable);
+    item->setCheckState(0, Qt::Unchecked);
+    item->setText(0, rel.filename().c_str());
+    item->setDisabled(false);
+
+    // expandable now, populated when expanded
+    if(_catalog->has_children(rel)) item->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
+
+    _exp_items[rel.c_str()] = item;
+
+    return item;
+}
+
+fs::path MainWindow::relative_path(QTreeWidgetItem* item) const
+{
+    QStack<QTreeWidgetItem*> stack;
+    QTreeWidgetItem* curr = item;
+
+    do {
+        stack.push(curr);
+    } while((curr = curr->parent()));
+
+    fs::path rel;
+    while(!stack.empty()) {
+        rel /= stack.pop()->text(0).toStdString();
+    }
+
+    return rel;
+}
+
+void MainWindow::populate(QTreeWidgetItem* item)
+{
+    if(is_populated(item)) return;
+
+    // new unchecked items must not reach on_exp_changed
+    QSignalBlocker blocker(ui->exp_menu);
+
+    item->setData(0, POPULATED_ROLE, true);
+
+    for(const auto& child : _catalog->children(relative_path(item))) {
+        add_exp_item(child);
+    }
+}
+
 void MainWindow::load()
 {
     auto menu = ui->exp_menu;
 
+    // second column holds the progress of the experiments being loaded
+    menu->setColumnCount(2);
     menu->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
 
-    QStack<QTreeWidgetItem*> items;
-    int prev_depth = -1;
+    // Only the first opening of a results tree walks it, the catalog saved
+    // then is reconciled in the background on the next ones
+    auto catalog = ExperimentCatalog::load(_stats_dir);
+    bool reconcile = catalog.has_value();
 
-    // Create tree menu to choose experiment
-    for(auto it = fs::recursive_directory_iterator{_stats_dir}; it != fs::recursive_directory_iterator(); ++it) {
-        QTreeWidgetItem * item = nullptr;
+    if(!catalog) {
+        catalog = ExperimentCatalog::scan(_stats_dir);
+        if(!catalog->save()) std::cout << "Could not save catalog : " << ExperimentCatalog::catalog_path(_stats_dir) << std::endl;
+    }
 
-        if(!it->is_directory()) continue;
+    set_catalog(std::make_shared<const ExperimentCatalog>(std::move(*catalog)));
 
-        if(it.depth() == prev_depth) items.pop();
-        else if(prev_depth != -1 && it.depth() < prev_depth) {
-            for(int i = it.depth(); i <= prev_depth; ++i) items.pop();
-        }
+    // Create tree menu to choose experiment, deeper levels are created
+    // when their parent is expanded
+    for(const auto& rel : _catalog->children({})) {
+        add_exp_item(rel);
+    }
 
-        if(it.depth() == 0) item = new QTreeWidgetItem(menu);
-        else item = new QTreeWidgetItem(items.top());
+    connect(menu, &QTreeWidget::itemExpanded, this, &MainWindow::populate);
+    connect(menu, &QTreeWidget::itemChanged, this, &MainWindow::on_exp_changed);
+
+    if(!reconcile) return;
+
+    _reconcile = std::jthread([this, catalog = _catalog](std::stop_token stop) {
+        auto updated = catalog->reconcile(stop);
+        if(!updated || updated->entries() == catalog->entries()) return;
+
+        updated->save();
+
+        auto shared = std::make_shared<const ExperimentCatalog>(std::move(*updated));
+        QMetaObject::invokeMethod(this, [this, shared]() { on_catalog_reconciled(shared); }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::on_catalog_reconciled(std::shared_ptr<const ExperimentCatalog> catalog)
+{
+    auto previous_catalog = _catalog;
+    set_catalog(std::move(catalog));
+
+    const auto& previous = previous_catalog->entries();
+    const auto& current = _catalog->entries();
 
-        item->setFlags(Qt::ItemIsUserCheckable);
-        item->setCheckState(0, Qt::Unchecked);
-        item->setText(0, it->path().filename().c_str());
-        item->setDisabled(false);
+    // no load or unload while the tree is edited
+    QSignalBlocker blocker(ui->exp_menu);
 
-        items.push(item);
-        prev_depth = it.depth();
+    // children before their parent
+    for(auto it = previous.rbegin(); it != previous.rend(); ++it) {
+        const auto& rel = it->first;
+        if(rel.empty() || current.contains(rel)) continue;
+
+        auto* item = _exp_items.take(rel.c_str());
+        if(!item) continue;
+
+        if(item->checkState(0) == Qt::Checked) unload_exp(fs::path(_stats_dir) / rel);
+
+        delete item;
     }
 
-    connect(menu, &QTreeWidget::itemChanged, this, &MainWindow::on_exp_changed);
+    for(const auto& [rel, exp] : current) {
+        if(rel.empty() || previous.contains(rel)) continue;
+
+        // only under the levels already shown
+        auto* parent = _exp_items.value(rel.parent_path().c_str(), nullptr);
+
+        if(rel.parent_path().empty() || (parent && is_populated(parent))) add_exp_item(rel);
+        else if(parent) parent->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
+    }
 }
 
 void MainWindow::on_exp_changed(QTreeWidgetItem* item, int column)
 {
-    if(item->childCount() > 0) {
+    if(has_children(item)) {
+        // the propagation below needs the children, expanded or not
+        populate(item);
+
+        // the whole subtree is loaded as one batch, the nested calls for the
+        // subdirectories belong to it
+        bool outer = !_propagating;
+        if(outer) {
+            _propagating = true;
+            begin_batch();
+        }
+
         for(int i = 0; i < item->childCount(); ++i) {
             auto child = item->child(i);
-            if(child->childCount() > 0 || child->text(0) == "average")
+            if(has_children(child) || child->text(0) == "average")
                 child->setCheckState(0, (child->checkState(0) == Qt::Checked) ? Qt::Unchecked : Qt::Checked);
         }
 
-        return;
-    }
-
-    fs::path path = _stats_dir;
-
-    QStack<QTreeWidgetItem*> stack;
-    QTreeWidgetItem* curr = item;
-
-    while((curr = dynamic_cast<QTreeWidgetItem*>(curr->parent()))) {
-        stack.push(curr);
-    }
+        if(outer) {
+            _propagating = false;
+            finish_batch();
+        }
 
-    while(!stack.empty()) {
-        path /= stack.pop()->text(0).toStdString();
+        return;
     }
 
-    path /= item->text(0).toStdString();
+    fs::path path = fs::path(_stats_dir) / relative_path(item);
 
     if(item->checkState(0) == Qt::Checked) {
-        _recv_display->load(path);
-        _medooze_display->load(path);
-        _qlog_display->load(path);
+        load_exp(item, path);
 
         /*_recv_display->add_to_all(path, _all_bitrate_display.get());
         _medooze_display->add_to_all(path, _all_bitrate_display.get());
@@ -115,13 +255,132 @@ void MainWindow::on_exp_changed(QTreeWidgetItem* item, int column)
         _all_bitrate_display->load(path);*/
     }
     else {
-        _recv_display->unload(path);
-        _medooze_display->unload(path);
-        _qlog_display->unload(path);
+        unload_exp(path);
         // _all_bitrate_display->unload(path);
     }
 }
 
+void MainWindow::load_exp(QTreeWidgetItem* item, const fs::path& path)
+{
+    int count = displays().size();
+    _pending[path.c_str()] = PendingLoad{ std::stop_source(), item, count };
+    _queued.push_back(path.c_str());
+
+    auto progress = new QProgressBar();
+    progress->setRange(0, count);
+    progress->setValue(0);
+    progress->setFormat("queued");
+    ui->exp_menu->setItemWidget(item, 1, progress);
+
+    start_loads();
+}
+
+void MainWindow::start_loads()
+{
+    int started = _pending.size() - _queued.size();
+
+    for(; started < _max_loading && !_queued.empty(); ++started) {
+        start_load(_queued.takeFirst());
+    }
+}
+
+void MainWindow::start_load(const QString& key)
+{
+    const auto& pending = _pending[key];
+
+    if(auto* progress = qobject_cast<QProgressBar*>(ui->exp_menu->itemWidget(pending.item, 1))) progress->setFormat("%v/%m");
+
+    std::erase_if(_parsing, [](const auto& f) { return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+
+    fs::path path = key.toStdString();
+    std::stop_source stop = pending.stop;
+
+    // The displays parse concurrently, each one is attached on this thread
+    // as soon as it is done
+    for(auto* display : displays()) {
+        _parsing.push_back(ThreadPool::global().submit([this, display, path, stop, catalog = _catalog]() {
+            DisplayBase::Attach attach;
+
+            try {
+                attach = display->parse(path, catalog.get(), stop.get_token());
+            }
+            catch(const std::exception& e) {
+                std::cout << "Could not load " << path << " : " << e.what() << std::endl;
+            }
+
+            QMetaObject::invokeMethod(this, [this, path, stop, attach]() { on_exp_parsed(path, stop, attach); }, Qt::QueuedConnection);
+        }));
+    }
+}
+
+void MainWindow::on_exp_parsed(const fs::path& path, const std::stop_source& stop, const DisplayBase::Attach& attach)
+{
+    auto it = _pending.find(path.c_str());
+
+    // unticked meanwhile, possibly ticked again since by a newer load
+    if(it == _pending.end() || it->stop != stop) return;
+
+    if(attach) attach();
+
+    auto* item = it->item;
+    int remaining = --it->remaining;
+
+    if(remaining > 0) {
+        if(auto* progress = qobject_cast<QProgressBar*>(ui->exp_menu->itemWidget(item, 1))) progress->setValue(progress->maximum() - remaining);
+        return;
+    }
+
+    ui->exp_menu->removeItemWidget(item, 1);
+    _pending.erase(it);
+
+    start_loads();
+    finish_batch();
+}
+
+void MainWindow::unload_exp(const fs::path& path)
+{
+    auto it = _pending.find(path.c_str());
+
+    // the results still to come are dropped by on_exp_parsed
+    if(it != _pending.end()) {
+        it->stop.request_stop();
+        ui->exp_menu->removeItemWidget(it->item, 1);
+
+        _queued.removeOne(path.c_str());
+        _pending.erase(it);
+
+        start_loads();
+    }
+
+    for(auto* display : displays()) {
+        display->unload(path);
+    }
+
+    finish_batch();
+}
+
+void MainWindow::begin_batch()
+{
+    if(_batch) return;
+
+    _batch = true;
+
+    for(auto* display : displays()) {
+        display->begin_batch();
+    }
+}
+
+void MainWindow::finish_batch()
+{
+    if(!_batch || _propagating || !_pending.empty()) return;
+
+    _batch = false;
+
+    for(auto* display : displays()) {
+        display->end_batch();
+    }
+}
+
 void MainWindow::on_screenshot()
 {
     fs::path dir = fs::temp_directory_path() / "tunnel_figures";
@@ -166,5 +425,13 @@ void MainWindow::on_impl_show(int checked)
 
 MainWindow::~MainWindow()
 {
+    // the reconciliation posts its result to this window
+    _reconcile.request_stop();
+    if(_reconcile.joinable()) _reconcile.join();
+
+    // so do the parses, their results are dropped with the window
+    for(auto& pending : _pending) pending.stop.request_stop();
+    ThreadPool::global().wait(_parsing);
+
     delete ui;
 }
@@ -2,12 +2,21 @@
 #define MAIN_WINDOW_H
 
 #include <QMainWindow>
+#include <QMap>
+
+#include <array>
+#include <future>
+#include <memory>
+#include <stop_token>
+#include <thread>
+#include <vector>
 
 #include "received_bitrate_display.h"
 #include "medooze_display.h"
 #include "qlog_display.h"
 #include "sent_loss_display.h"
 #include "all_bitrate.h"
+#include "experiment_catalog.h"
 
 namespace Ui {
 class MainWindow;
@@ -21,6 +30,42 @@ class MainWindow : public QMainWindow
 
     std::string _stats_dir;
 
+    std::shared_ptr<const ExperimentCatalog> _catalog;
+    QMap<QString, QTreeWidgetItem*> _exp_items;  // by path relative to _stats_dir
+
+    // Experiment ticked and not attached yet to all the displays
+    struct PendingLoad
+    {
+        std::stop_source stop;
+        QTreeWidgetItem* item = nullptr;
+        int remaining = 0;  // displays not attached yet
+    };
+
+    QMap<QString, PendingLoad> _pending;  // by absolute path
+    QList<QString> _queued;               // not started yet, in tick order
+    std::vector<std::future<void>> _parsing;
+
+    // experiments parsed at the same time, $STATS_VIEWER_MAX_LOADS when set
+    int _max_loading = 1;
+
+    // the displays refresh their charts once the pending loads are done
+    bool _batch = false;
+    bool _propagating = false;  // a check is being propagated to a subtree
+
+    void set_catalog(std::shared_ptr<const ExperimentCatalog> catalog);
+    QTreeWidgetItem* add_exp_item(const fs::path& rel);
+    fs::path relative_path(QTreeWidgetItem* item) const;
+    void on_catalog_reconciled(std::shared_ptr<const ExperimentCatalog> catalog);
+
+    std::array<DisplayBase*, 3> displays() const;
+    void load_exp(QTreeWidgetItem* item, const fs::path& path);
+    void start_loads();
+    void start_load(const QString& path);
+    void unload_exp(const fs::path& path);
+    void begin_batch();
+    void finish_batch();
+    void on_exp_parsed(const fs::path& path, const std::stop_source& stop, const DisplayBase::Attach& attach);
+
 public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
@@ -40,9 +85,13 @@ private:
     std::unique_ptr<SentLossDisplay> _sent_loss_display;
     std::unique_ptr<AllBitrateDisplay> _all_bitrate_display;
 
+    // background reconciliation of the catalog with the results tree
+    std::jthread _reconcile;
+
 public slots:
 
     void on_exp_changed(QTreeWidgetItem* item, int column);
+    void populate(QTreeWidgetItem* item);
     void on_screenshot();
     void on_ratio_1_0_7();
     void on_ratio_1_1();
@@ -0,0 +1,60 @@
+#include "mapped_file.h"
+
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const fs::path& p)
+{
+    int fd = ::open(p.c_str(), O_RDONLY);
+    if(fd < 0) {
+        throw std::runtime_error("Could not open file with provided path : " + p.string());
+    }
+
+    struct stat st;
+    if(::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not stat file : " + p.string());
+    }
+
+    _size = static_cast<size_t>(st.st_size);
+
+    // mmap refuses zero length mappings, an empty file is simply an empty view
+    if(_size > 0) {
+        void* addr = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(addr == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Could not map file : " + p.string());
+        }
+
+        ::madvise(addr, _size, MADV_SEQUENTIAL);
+        _data = static_cast<const char*>(addr);
+    }
+
+    ::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if(_data) ::munmap(const_cast<char*>(_data), _size);
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : _data(std::exchange(other._data, nullptr)), _size(std::exchange(other._size, 0))
+{}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if(this != &other) {
+        if(_data) ::munmap(const_cast<char*>(_data), _size);
+
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+    }
+
+    return *this;
+}
@@ -0,0 +1,34 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <filesystem>
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+// Read-only memory mapping of a whole file. The mapping lives as long as the
+// object, so string_views handed out by view() must not outlive it.
+class MappedFile
+{
+    const char* _data = nullptr;
+    size_t _size = 0;
+
+public:
+    MappedFile() = default;
+    explicit MappedFile(const fs::path& p);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const char* data() const { return _data; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    std::string_view view() const { return {_data, _size}; }
+};
+
+#endif // MAPPED_FILE_H
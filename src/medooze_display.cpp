@@ -5,11 +5,29 @@
 #include <QTreeWidgetItem>
 #include <QValueAxis>
 
+#include <iostream>
+#include <memory>
+#include <numeric>
+
 #include "medooze_display.h"
 
 #include "csv_reader.h"
+#include "input_file.h"
+#include "column_cache.h"
 #include "stats_line_chart.h"
 #include "all_bitrate.h"
+#include "thread_pool.h"
+
+namespace
+{
+
+double max_y(const QList<QPointF>& points)
+{
+    auto it = std::max_element(points.begin(), points.end(), [](const auto& p1, const auto& p2) { return p1.y() < p2.y(); });
+    return (it != points.end()) ? it->y() : 0.;
+}
+
+}
 
 MedoozeDisplay::MedoozeDisplay(QWidget* tab, QVBoxLayout* layout, QListWidget* legend, QTreeWidget* info)
     : DisplayBase(tab, legend, info)
@@ -36,64 +54,115 @@ void MedoozeDisplay::on_keyboard_event(QKeyEvent* key)
         if(_chart_view_bitrate->isHidden()) _chart_view_bitrate->show();
         else _chart_view_bitrate->hide();
     }
+    else if(key->key() == Qt::Key_W) {
+        set_rate_window(next_rate_window(_rate_window));
+    }
+}
+
+MedoozeDisplay::~MedoozeDisplay()
+{
+    // the recomputations post their rates to this display
+    _rates_stop.request_stop();
+    ThreadPool::global().wait(_rates);
 }
 
-void MedoozeDisplay::init_map(StatMap& map, bool signal)
+void MedoozeDisplay::set_rate_window(RateWindow window)
 {
-    map[StatKey::BWE] = std::make_tuple("Bwe", nullptr, _chart_bitrate, ExpInfo{}, false);
-    map[StatKey::TARGET] = std::make_tuple("Target", nullptr, _chart_bitrate, ExpInfo{}, false);
-    // map[StatKey::AVAILABLE_BITRATE] = std::make_tuple("Available bitrate", nullptr, _chart_bitrate);
-    map[StatKey::RTT] = std::make_tuple("RTT", nullptr, _chart_rtt, ExpInfo{}, false);
-    map[StatKey::RTX] = std::make_tuple("RTX", nullptr, _chart_bitrate, ExpInfo{}, false);
-    map[StatKey::PROBING] = std::make_tuple("Probing", nullptr, _chart_bitrate, ExpInfo{}, false);
-    map[StatKey::MEDIA] = std::make_tuple("Media", nullptr, _chart_bitrate, ExpInfo{}, false);
-    map[StatKey::LOSS] = std::make_tuple("Loss", nullptr, _chart_bitrate, ExpInfo{}, false);
-    map[StatKey::MINRTT] = std::make_tuple("Min rtt", nullptr, _chart_rtt, ExpInfo{}, false);
-    map[StatKey::TOTAL] = std::make_tuple("Total", nullptr, _chart_bitrate, ExpInfo{}, false);
-    map[StatKey::RECEIVED_BITRATE] = std::make_tuple("Received bitrate", nullptr, _chart_bitrate, ExpInfo{}, false);
-    map[StatKey::FBDELAY] = std::make_tuple("Feedback delay", nullptr, _chart_rtt, ExpInfo{}, false);
-    map[StatKey::LOSS_ACCUMULATED] = std::make_tuple("Loss accumulated", nullptr, _chart_rtt, ExpInfo{}, false);
-
-    map[StatKey::MEDIA_BOX] = std::make_tuple("Media box", nullptr, _chart_bitrate, ExpInfo{}, false);
-    map[StatKey::TARGET_BOX] = std::make_tuple("Target box", nullptr, _chart_bitrate, ExpInfo{}, false);
-    map[StatKey::RTT_BOX] = std::make_tuple("rtt box", nullptr, _chart_rtt, ExpInfo{}, false);
-
-    map[StatKey::MEDIA_INTERQUARTILE] = std::make_tuple("Media", nullptr, _chart_bitrate, ExpInfo{}, false);
-    map[StatKey::TARGET_INTERQUARTILE] = std::make_tuple("Target", nullptr, _chart_bitrate, ExpInfo{}, false);
-    map[StatKey::RTT_INTERQUARTILE] = std::make_tuple("RTT", nullptr, _chart_rtt, ExpInfo{}, false);
-
-    if(signal) {
-        connect(_legend, &QListWidget::itemChanged, this, [&map](QListWidgetItem* item) -> void {
-            StatKey key = static_cast<StatKey>(item->data(1).toUInt());
-
-            std::get<StatsKeyProperty::SHOW>(map[key]) = item->checkState() == Qt::Checked;
-
-            auto line = std::get<StatsKeyProperty::SERIE>(map[key]);
-            if(line == nullptr) return;
-
-            if(item->checkState() ==  Qt::Checked) line->show();
-            else line->hide();
-        });
+    _rate_window = window;
+
+    // the previous recomputation is dropped, its batch is kept open for
+    // this one
+    _rates_stop.request_stop();
+    _rates_stop = std::stop_source();
+
+    std::erase_if(_rates, [](const auto& f) { return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+
+    if(_rates_pending == 0 && !_packet_files.isEmpty()) begin_batch();
+    _rates_pending = _packet_files.size();
+
+    // the packet columns are read back from their cache, not from the csv.
+    // The GUI thread does not wait, each experiment is updated when its
+    // rates are ready.
+    for(const auto& p : _packet_files.keys()) {
+        _rates.push_back(ThreadPool::global().submit([this, p, path = _packet_files.value(p), window, stop = _rates_stop]() {
+            auto rates = std::make_shared<Rates>();
+
+            try {
+                if(stage_packets(path, window, rates->staged, rates->info, stop.get_token())) {
+                    rates->max_loss = max_y(rates->staged.points[StatKey::LOSS]);
+                    rates->staged.index();
+                }
+                else {
+                    rates.reset();
+                }
+            }
+            catch(const std::exception& e) {
+                std::cout << "Could not compute the rates of " << path << " : " << e.what() << std::endl;
+                rates.reset();
+            }
+
+            QMetaObject::invokeMethod(this, [this, p, path, stop, rates]() { on_rates_staged(p, path, stop, rates); }, Qt::QueuedConnection);
+        }));
     }
 }
 
-void MedoozeDisplay::set_makeup(const fs::path& path)
+void MedoozeDisplay::on_rates_staged(const QString& p, const fs::path& path, const std::stop_source& stop, std::shared_ptr<const Rates> rates)
 {
-    const auto& map = _path_keys[path.c_str()];
+    // superseded by another window, counted by the newer recomputation
+    if(stop.stop_requested()) return;
+
+    // unloaded meanwhile or failed, but still back
+    auto exp = find_experiment(p.toStdString());
+    if(rates && exp && _packet_files.value(p) == path) {
+        for(auto key : { StatKey::MEDIA, StatKey::RTX, StatKey::PROBING, StatKey::TOTAL, StatKey::RECEIVED_BITRATE, StatKey::LOSS }) {
+            if(rates->staged.pyramids[key]) set_detail(exp, key, rates->staged.pyramids[key]);
+        }
 
-    QFont font = _chart_bitrate->font();
-    font.setPointSize(40);
-    font.setBold(true);
+        _max_loss[p] = rates->max_loss;
 
-    _chart_bitrate->legend()->setMarkerShape(QLegend::MarkerShapeFromSeries);
-    _chart_bitrate->legend()->setFont(font);
-    _chart_bitrate->legend()->detachFromChart();
+        if(auto* item = _info_items.value(p)) {
+            for(const auto* stats : { &rates->info.media, &rates->info.rtx, &rates->info.probing, &rates->info.total, &rates->info.received }) {
+                for(int i = 0; i < item->childCount(); ++i) {
+                    if(item->child(i)->text(0) == stats->name) stats->fill(item->child(i));
+                }
+            }
+        }
+    }
 
-    _chart_rtt->legend()->setMarkerShape(QLegend::MarkerShapeFromSeries);
-    _chart_rtt->legend()->setFont(font);
-    _chart_rtt->legend()->detachFromChart();
+    if(--_rates_pending == 0) end_batch();
+}
 
-    for(const auto& [name, abs_serie, chart, info, show] : map) {
+void MedoozeDisplay::init_map(Experiment& exp)
+{
+    exp.declare(StatKey::BWE, {"Bwe", nullptr, _chart_bitrate, ExpInfo{}, false});
+    exp.declare(StatKey::TARGET, {"Target", nullptr, _chart_bitrate, ExpInfo{}, false});
+    // exp.declare(StatKey::AVAILABLE_BITRATE, {"Available bitrate", nullptr, _chart_bitrate});
+    exp.declare(StatKey::RTT, {"RTT", nullptr, _chart_rtt, ExpInfo{}, false});
+    exp.declare(StatKey::RTX, {"RTX", nullptr, _chart_bitrate, ExpInfo{}, false});
+    exp.declare(StatKey::PROBING, {"Probing", nullptr, _chart_bitrate, ExpInfo{}, false});
+    exp.declare(StatKey::MEDIA, {"Media", nullptr, _chart_bitrate, ExpInfo{}, false});
+    exp.declare(StatKey::LOSS, {"Loss", nullptr, _chart_bitrate, ExpInfo{}, false});
+    exp.declare(StatKey::MINRTT, {"Min rtt", nullptr, _chart_rtt, ExpInfo{}, false});
+    exp.declare(StatKey::TOTAL, {"Total", nullptr, _chart_bitrate, ExpInfo{}, false});
+    exp.declare(StatKey::RECEIVED_BITRATE, {"Received bitrate", nullptr, _chart_bitrate, ExpInfo{}, false});
+    exp.declare(StatKey::FBDELAY, {"Feedback delay", nullptr, _chart_rtt, ExpInfo{}, false});
+    exp.declare(StatKey::LOSS_ACCUMULATED, {"Loss accumulated", nullptr, _chart_rtt, ExpInfo{}, false});
+
+    exp.declare(StatKey::MEDIA_BOX, {"Media box", nullptr, _chart_bitrate, ExpInfo{}, false});
+    exp.declare(StatKey::TARGET_BOX, {"Target box", nullptr, _chart_bitrate, ExpInfo{}, false});
+    exp.declare(StatKey::RTT_BOX, {"rtt box", nullptr, _chart_rtt, ExpInfo{}, false});
+
+    exp.declare(StatKey::MEDIA_INTERQUARTILE, {"Media", nullptr, _chart_bitrate, ExpInfo{}, false});
+    exp.declare(StatKey::TARGET_INTERQUARTILE, {"Target", nullptr, _chart_bitrate, ExpInfo{}, false});
+    exp.declare(StatKey::RTT_INTERQUARTILE, {"RTT", nullptr, _chart_rtt, ExpInfo{}, false});
+}
+
+void MedoozeDisplay::set_makeup(const fs::path& path)
+{
+    auto exp = find_experiment(path);
+    if(!exp) return;
+
+    for(const auto& [name, abs_serie, chart, info, show] : exp->slots()) {
         auto* serie = dynamic_cast<QLineSeries*>(abs_serie);
         if(!serie) continue;
 
@@ -111,6 +180,44 @@ void MedoozeDisplay::set_makeup(const fs::path& path)
 
         serie->setPen(pen);
     }
+}
+
+void MedoozeDisplay::refresh_charts()
+{
+    _chart_bitrate->createDefaultAxes();
+    _chart_rtt->createDefaultAxes();
+
+    // loss of the experiments is drawn against its own axis
+    if(!_max_loss.empty()) {
+        auto loss_axis = new QValueAxis();
+
+        double max_loss = *std::max_element(_max_loss.cbegin(), _max_loss.cend());
+        if(max_loss > 0) loss_axis->setRange(0, max_loss * 2);
+
+        _chart_bitrate->addAxis(loss_axis, Qt::AlignRight);
+
+        for(auto it = _max_loss.cbegin(); it != _max_loss.cend(); ++it) {
+            auto exp = find_experiment(it.key().toStdString());
+            auto* serie = exp ? (*exp)[StatKey::LOSS].serie : nullptr;
+            if(!serie) continue;
+
+            auto axis = serie->attachedAxes();
+            if(!axis.empty()) serie->detachAxis(axis.back());
+            serie->attachAxis(loss_axis);
+        }
+    }
+
+    QFont font = _chart_bitrate->font();
+    font.setPointSize(40);
+    font.setBold(true);
+
+    _chart_bitrate->legend()->setMarkerShape(QLegend::MarkerShapeFromSeries);
+    _chart_bitrate->legend()->setFont(font);
+    _chart_bitrate->legend()->detachFromChart();
+
+    _chart_rtt->legend()->setMarkerShape(QLegend::MarkerShapeFromSeries);
+    _chart_rtt->legend()->setFont(font);
+    _chart_rtt->legend()->detachFromChart();
 
     auto setup_axes = [&font](auto&& axe,const std::string& name) {
         axe->setTitleText(name.c_str());
@@ -127,7 +234,7 @@ void MedoozeDisplay::set_makeup(const fs::path& path)
     if(!axes.empty()) setup_axes(axes.front(), "Time (s)");
 
     axes = _chart_bitrate->axes(Qt::Vertical);
-    if(!axes.empty()) setup_axes(axes.front(), "Bitrate (kbps)");
+    if(!axes.empty()) setup_axes(axes.front(), std::string("Bitrate (kbps, ") + rate_window_name(_rate_window) + ")");
     if(axes.size() == 2) setup_axes(axes.back(), "Loss");
 
     axes = _chart_rtt->axes(Qt::Horizontal);
@@ -139,24 +246,31 @@ void MedoozeDisplay::set_makeup(const fs::path& path)
 
 void MedoozeDisplay::Info::Stats::process(QTreeWidgetItem* root)
 {
-    mean /= n;
-    variance = (variance / n) - (mean * mean);
-    var_coeff = std::sqrt(variance) / mean;
-
     QTreeWidgetItem * item = new QTreeWidgetItem(root);
     item->setText(0, name);
 
+    fill(item);
+}
+
+void MedoozeDisplay::Info::Stats::fill(QTreeWidgetItem* item) const
+{
+    double var_coeff = std::sqrt(variance()) / mean();
+
+    qDeleteAll(item->takeChildren());
+
     QTreeWidgetItem * mean_item = new QTreeWidgetItem(item);
     mean_item->setText(0, "mean");
-    mean_item->setText(1, QString::number(mean));
+    mean_item->setText(1, QString::number(mean()));
 
     QTreeWidgetItem * variance_item = new QTreeWidgetItem(item);
     variance_item->setText(0, "variance");
-    variance_item->setText(1, QString::number(variance));
+    variance_item->setText(1, QString::number(variance()));
 
     QTreeWidgetItem * coeff_var_item = new QTreeWidgetItem(item);
     coeff_var_item->setText(0, "variation coeff");
     coeff_var_item->setText(1, QString::number(var_coeff));
+
+    add_percentiles(item, {}, percentiles());
 }
 
 void MedoozeDisplay::Info::StatsLoss::process(QTreeWidgetItem* root)
@@ -179,271 +293,259 @@ void MedoozeDisplay::Info::StatsLoss::process(QTreeWidgetItem* root)
     percent_item->setText(1, QString::number(percent));
 }
 
-template<typename T>
-concept MedoozeStat = requires(T t) { t.update({}); };
+// Columns of medooze.csv / quic-relay-*.csv
+using MedoozeSchema = CsvSchema<"fb_ts", "twcc_num", "fb_num", "packet_size", "sent_time", "recv_ts",
+                                "delta_sent", "delta_recv", "delta", "bwe", "target", "available_bitrate",
+                                "rtt", "minrtt", "flag", "rtx", "probing">;
 
-template<MedoozeStat Stat>
-struct Accu
+// Only the columns used by load_exp are converted
+using MedoozeReader = ProjectedCsvReader<'|', MedoozeSchema, int,
+                                         "packet_size", "sent_time", "recv_ts", "target", "rtt", "minrtt", "rtx", "probing">;
+
+namespace
 {
-    int current_ts = -1;
-    int sum = 0;
-    MedoozeDisplay::StatKey key;
-    static constexpr int base = 1000000;
-    static constexpr int window = 200000;
 
-    Stat* stats;
+fs::path find_medooze_csv(const ExperimentCatalog* catalog, const fs::path& p)
+{
+    return find_data_file(catalog, p, [](const fs::path& file) {
+        auto name = strip_compression(file);
 
-    double factor = base / window;
+        return name.filename().string().starts_with("quic-relay-") && name.extension() == ".csv"
+            || name.filename().string() == "medooze.csv";
+    });
+}
 
-    QList<QPointF> points;
-    QList<QPoint> points_window;
-    QPointF pt;
+MedoozeReader::columns_type read_medooze_csv(const fs::path& path)
+{
+    return column_cache::load<MedoozeReader::columns_type>(path, "medooze:packet_size,sent_time,recv_ts,target,rtt,minrtt,rtx,probing", [&path]() {
+        return MedoozeReader(path).read_columns_parallel();
+    });
+}
 
-    uint64_t accumulated = 0;
+}
 
-    Accu(MedoozeDisplay::StatKey k,  Stat* in_stats = nullptr) : pt{0., 0.}, stats(in_stats)
-    {
-        key = k;
-    }
+void MedoozeDisplay::warm_cache(const fs::path& p)
+{
+    fs::path path = find_medooze_csv(nullptr, p);
+    if(!path.empty()) read_medooze_csv(path);
+}
 
-    void accumulate(int time, int v)
-    {
-        while(!points_window.empty() && points_window.front().x() < (time  - window)) {
-            accumulated -= points_window.front().y();
-            points_window.pop_front();
-        }
+bool MedoozeDisplay::stage_packets(const fs::path& path, RateWindow window, Staged& staged, Info& info, std::stop_token stop)
+{
+    const auto [packet_size, sent_time, recv_ts, target, rtt, minrtt, rtx, probing] = read_medooze_csv(path);
+    if(stop.stop_requested()) return false;
 
-        accumulated += v;
-        points_window.emplace_back(time, v);
+    // the windows slide over the send time, retransmissions are logged
+    // out of order
+    std::vector<uint32_t> order(sent_time.size());
+    std::iota(order.begin(), order.end(), 0);
 
-        if(key == MedoozeDisplay::StatKey::LOSS) {
-            points.emplace_back(time/1000000., accumulated);
-            stats->update(v);
-        }
-        else {
-            points.emplace_back(time/1000000., accumulated * factor / 1000.);
-            stats->update(points.back().y());
-        }
+    if(!std::ranges::is_sorted(sent_time)) {
+        std::ranges::stable_sort(order, {}, [&sent_time](uint32_t i) { return sent_time[i]; });
     }
 
-    void add_value(double time, double v)
-    {
-        points.emplace_back(time, v);
-        stats->update(v);
+    enum Channel { MEDIA, RTX, PROBING, TOTAL, RECEIVED, LOST, NUM_CHANNELS };
+    WindowedRate<NUM_CHANNELS> rates(window);
+
+    // one point per packet in every serie
+    for(auto key : { StatKey::MEDIA, StatKey::RTX, StatKey::PROBING, StatKey::TOTAL, StatKey::RECEIVED_BITRATE,
+                     StatKey::LOSS, StatKey::RTT, StatKey::MINRTT, StatKey::LOSS_ACCUMULATED }) {
+        staged.reserve(key, sent_time.size());
     }
 
-    void add_value(int ts, double time, double v)
-    {
-        if(ts != current_ts) {
-            if(current_ts != -1) {
-                pt.setX(pt.x() / sum);
-                pt.setY(pt.y() / sum);
+    double kbps = rates.per_second() / 1000.;
+    size_t count = 0;
 
-                points.push_back(pt);
-            }
+    for(uint32_t i : order) {
+        // a superseded window or load does not run to the end
+        if((++count & 0xffff) == 0 && stop.stop_requested()) return false;
 
-            current_ts = ts;
-            sum = 0;
+        double timestamp = sent_time[i] / 1000000.;
+        int size = packet_size[i] * 8;
+        bool lost = (sent_time[i] > 0 && recv_ts[i] == 0);
 
-            pt.setX(0.);
-            pt.setY(0.);
-        }
+        const auto amounts = rates.add(sent_time[i], { (rtx[i] == 0 && probing[i] == 0) ? size : 0,
+                                                       (rtx[i] == 1 && probing[i] == 0) ? size : 0,
+                                                       (rtx[i] == 0 && probing[i] == 1) ? size : 0,
+                                                       size,
+                                                       lost ? 0 : size,
+                                                       lost ? 1 : 0 });
 
-        pt.setX(pt.x() + time);
-        pt.setY(pt.y() + v);
+        auto add_rate = [&](StatKey key, Channel channel, Info::Stats& stats) {
+            staged.add_point(key, { timestamp, amounts[channel] * kbps });
+            stats.add(amounts[channel] * kbps);
+        };
 
-        ++sum;
-    }
+        add_rate(StatKey::MEDIA, MEDIA, info.media);
+        add_rate(StatKey::RTX, RTX, info.rtx);
+        add_rate(StatKey::PROBING, PROBING, info.probing);
+        add_rate(StatKey::TOTAL, TOTAL, info.total);
+        add_rate(StatKey::RECEIVED_BITRATE, RECEIVED, info.received);
 
-    const QList<QPointF>& get_points()
-    {
-        std::sort(points.begin(), points.end(),
-                  [](const auto& p1, const auto& p2) { return p1.x() < p2.x(); });
+        // lost packets of the window, not a rate
+        staged.add_point(StatKey::LOSS, { timestamp, amounts[LOST] });
+        info.loss.update(lost ? 1 : 0);
 
-        return points;
-    }
-};
+        staged.add_point(StatKey::RTT, { timestamp, static_cast<double>(rtt[i]) });
+        info.rtt.add(rtt[i]);
 
-void MedoozeDisplay::load_exp(const fs::path& p)
-{
-    fs::path path;
-    for (auto const& dir_entry : std::filesystem::recursive_directory_iterator{p}) {
-        if(dir_entry.path().filename().string().starts_with("quic-relay-") && dir_entry.path().extension() == ".csv"
-            || dir_entry.path().filename().string() == "medooze.csv") {
-            path = dir_entry.path();
-            break;
-        }
+        double min = (minrtt[i] == 0 || rtt[i] < minrtt[i]) ? rtt[i] : minrtt[i];
+        staged.add_point(StatKey::MINRTT, { timestamp, min });
+        info.minrtt.add(min);
+
+        info.target.add(target[i]);
+
+        staged.add_point(StatKey::LOSS_ACCUMULATED, { timestamp, static_cast<double>(info.loss.loss) });
     }
 
-    using MedoozeReader = CsvReaderTypeRepeat<'|', int, 17>;
+    info.summarize();
 
-    // create_serie(p, StatKey::BITRATE);
-    create_serie(p, StatKey::MEDIA);
-    create_serie(p, StatKey::RTX);
-    create_serie(p, StatKey::PROBING);
-    create_serie(p, StatKey::RTT);
-    create_serie(p, StatKey::MINRTT);
-    create_serie(p, StatKey::TARGET);
-    create_serie(p, StatKey::TOTAL);
-    create_serie(p, StatKey::RECEIVED_BITRATE);
-    create_serie(p, StatKey::LOSS);
-    create_serie(p, StatKey::LOSS_ACCUMULATED);
+    return !stop.stop_requested();
+}
+
+DisplayBase::Attach MedoozeDisplay::parse_exp(const fs::path& p, const ExperimentCatalog* catalog, std::stop_token stop)
+{
+    fs::path path = find_medooze_csv(catalog, p);
 
     Info info;
+    Staged staged;
 
-    auto accu_media = Accu<Info::Stats>(StatKey::MEDIA, &info.media);
-    auto accu_rtx = Accu<Info::Stats>(StatKey::RTX, &info.rtx);
-    auto accu_probing = Accu<Info::Stats>(StatKey::PROBING, &info.probing);
-    auto accu_rtt = Accu<Info::Stats>(StatKey::RTT, &info.rtt);
-    auto accu_minrtt = Accu<Info::Stats>(StatKey::MINRTT, &info.minrtt);
-    auto accu_target = Accu<Info::Stats>(StatKey::TARGET, &info.target);
-    auto accu_total = Accu<Info::Stats>(StatKey::TOTAL, &info.total);
-    auto accu_loss = Accu<Info::StatsLoss>(StatKey::LOSS, &info.loss);
-    auto accu_received = Accu<Info::Stats>(StatKey::RECEIVED_BITRATE, &info.received);
-
-    for(auto &it : MedoozeReader(path)) {
-        const auto& [fb_ts, twcc_num, fb_num, packet_size, sent_time, recv_ts, delta_sent, delta_recv, delta,
-                     bwe, target, available_bitrate, rtt, minrtt, flag, rtx, probing] = it;
-
-        double timestamp = sent_time / 1000000.;
-
-        accu_media.accumulate(sent_time, ((rtx == 0 && probing == 0) ? packet_size * 8 : 0));
-        accu_rtx.accumulate(sent_time, ((rtx == 1 && probing == 0) ? packet_size * 8 : 0));
-        accu_probing.accumulate(sent_time, ((rtx == 0 && probing == 1) ? packet_size * 8 : 0));
-        accu_rtt.add_value(timestamp, rtt);
-        accu_minrtt.add_value(timestamp, ((minrtt == 0 || rtt < minrtt) ? rtt : minrtt));
-        accu_target.add_value(timestamp, target);
-        accu_total.accumulate(sent_time, packet_size * 8);
-        accu_loss.accumulate(sent_time, ((sent_time > 0 && recv_ts == 0) ? 1 : 0));
-        accu_received.accumulate(sent_time, ((sent_time > 0 && recv_ts == 0) ? 0 : packet_size * 8));
-
-        QPointF loss_pt(timestamp, info.loss.loss);
-        add_point(p.c_str(), StatKey::LOSS_ACCUMULATED, loss_pt);
-    }
+    if(!stage_packets(path, _rate_window, staged, info, stop)) return {};
 
-    auto& map = _path_keys[p.c_str()];
-    for(auto it : map.keys()) {
-        auto info = std::get<StatsKeyProperty::INFO>(map[it]);
-        info.stream = false;
-        std::get<StatsKeyProperty::INFO>(map[it]) = info;
-    }
+    double max_loss = max_y(staged.points[StatKey::LOSS]);
 
+    staged.index();
 
-    QTreeWidgetItem * item = new QTreeWidgetItem(_info);
-    item->setText(0, path.parent_path().filename().c_str());
-
-    process(item, info.media, p.c_str(), StatKey::MEDIA, accu_media.get_points());
-    process(item, info.rtx, p.c_str(), StatKey::RTX, accu_rtx.get_points());
-    process(item, info.probing, p.c_str(), StatKey::PROBING, accu_probing.get_points());
-    process(item, info.total, p.c_str(), StatKey::TOTAL, accu_total.get_points());
-    process(item, info.rtt, p.c_str(), StatKey::RTT, accu_rtt.get_points());
-    process(item, info.minrtt, p.c_str(), StatKey::MINRTT, accu_minrtt.get_points());
-    process(item, info.loss, p.c_str(), StatKey::LOSS, accu_loss.get_points());
-    process(item, info.received, p.c_str(), StatKey::RECEIVED_BITRATE, accu_received.get_points());
-    // add_serie(p.c_str(), StatKey::LOSS_ACCUMULATED);
+    return [this, p, path, info, staged = std::move(staged), max_loss]() mutable {
+        auto exp = experiment(p);
 
-    _chart_bitrate->createDefaultAxes();
-    _chart_rtt->createDefaultAxes();
+        // create_serie(p, StatKey::BITRATE);
+        create_serie(exp, StatKey::MEDIA);
+        create_serie(exp, StatKey::RTX);
+        create_serie(exp, StatKey::PROBING);
+        create_serie(exp, StatKey::RTT);
+        create_serie(exp, StatKey::MINRTT);
+        create_serie(exp, StatKey::TARGET);
+        create_serie(exp, StatKey::TOTAL);
+        create_serie(exp, StatKey::RECEIVED_BITRATE);
+        create_serie(exp, StatKey::LOSS);
+        create_serie(exp, StatKey::LOSS_ACCUMULATED);
 
-    auto loss_axis = new QValueAxis();
+        attach_points(exp, staged);
 
-    auto it = std::max_element(accu_loss.points.begin(), accu_loss.points.end(),
-                               [](const auto& p1, const auto& p2) { return p1.y() < p2.y();});
+        for(auto& slot : exp->slots()) slot.info.stream = false;
 
-    if(it != accu_loss.points.end()) {
-        auto max_loss = it->y();
-        loss_axis->setRange(0, max_loss * 2);
-    }
 
-    _chart_bitrate->addAxis(loss_axis, Qt::AlignRight);
+        QTreeWidgetItem * item = new QTreeWidgetItem(_info);
+        item->setText(0, path.parent_path().filename().c_str());
 
-    // const auto& map = _path_keys[p.c_str()];
-    auto* serie = std::get<StatsKeyProperty::SERIE>(map[StatKey::LOSS]);
+        process(exp, StatKey::MEDIA, item, info.media);
+        process(exp, StatKey::RTX, item, info.rtx);
+        process(exp, StatKey::PROBING, item, info.probing);
+        process(exp, StatKey::TOTAL, item, info.total);
+        process(exp, StatKey::RTT, item, info.rtt);
+        process(exp, StatKey::MINRTT, item, info.minrtt);
+        process(exp, StatKey::LOSS, item, info.loss);
+        process(exp, StatKey::RECEIVED_BITRATE, item, info.received);
+        // add_serie(exp, StatKey::LOSS_ACCUMULATED);
 
-    auto axis = serie->attachedAxes();
-    serie->detachAxis(axis.back());
-    serie->attachAxis(loss_axis);
+        _max_loss[p.c_str()] = max_loss;
+        _packet_files[p.c_str()] = path;
+        _info_items[p.c_str()] = item;
 
-    emit on_loss_stats(p, info.loss.loss, info.loss.sent);
+        emit on_loss_stats(p, info.loss.loss, info.loss.sent);
+    };
 }
 
 void MedoozeDisplay::load_average(const fs::path& p)
 {
-    fs::path medooze_file = p / "medooze.csv";
+    fs::path medooze_file = find_input(p / "medooze.csv");
 
     using MedoozeReader = CsvReaderTypeRepeat<',', double, 10>;
 
-    create_serie(p, StatKey::MEDIA);
-    create_serie(p, StatKey::RTX);
-    create_serie(p, StatKey::PROBING);
-    create_serie(p, StatKey::RTT);
-    create_serie(p, StatKey::MINRTT);
-    create_serie(p, StatKey::TOTAL);
-    create_serie(p, StatKey::FBDELAY);
-    create_serie(p, StatKey::RECEIVED_BITRATE);
-    create_serie(p, StatKey::TARGET);
+    auto exp = experiment(p);
+
+    create_serie(exp, StatKey::MEDIA);
+    create_serie(exp, StatKey::RTX);
+    create_serie(exp, StatKey::PROBING);
+    create_serie(exp, StatKey::RTT);
+    create_serie(exp, StatKey::MINRTT);
+    create_serie(exp, StatKey::TOTAL);
+    create_serie(exp, StatKey::FBDELAY);
+    create_serie(exp, StatKey::RECEIVED_BITRATE);
+    create_serie(exp, StatKey::TARGET);
 
     QPointF point;
 
     Info info;
+    Staged staged;
 
-    for(auto &it : MedoozeReader(medooze_file)) {
-        const auto& [ts, media, rtx, probing, recv, fb_delay, target, minrtt, rtt, loss] = it;
+    const auto [ts, media, rtx, probing, recv, fb_delay, target, minrtt, rtt, loss] = MedoozeReader(medooze_file).read_columns();
 
-        double timestamp = ts / 1000000.;
+    for(auto key : { StatKey::MEDIA, StatKey::RTX, StatKey::PROBING, StatKey::TOTAL, StatKey::RECEIVED_BITRATE,
+                     StatKey::TARGET, StatKey::RTT, StatKey::MINRTT, StatKey::FBDELAY }) {
+        staged.reserve(key, ts.size());
+    }
+
+    for(size_t i = 0; i < ts.size(); ++i) {
+        double timestamp = ts[i] / 1000000.;
         point.setX(timestamp);
 
-        point.setY(media / 1000.);
-        add_point(p.c_str(), StatKey::MEDIA, point);
-        info.media.update(media / 1000.);
+        point.setY(media[i] / 1000.);
+        staged.add_point(StatKey::MEDIA, point);
+        info.media.add(media[i] / 1000.);
 
-        point.setY(rtx / 1000.);
-        add_point(p.c_str(), StatKey::RTX, point);
-        info.rtx.update(rtx / 1000.);
+        point.setY(rtx[i] / 1000.);
+        staged.add_point(StatKey::RTX, point);
+        info.rtx.add(rtx[i] / 1000.);
 
-        point.setY(probing / 1000.);
-        add_point(p.c_str(), StatKey::PROBING, point);
-        info.probing.update(probing / 1000.);
+        point.setY(probing[i] / 1000.);
+        staged.add_point(StatKey::PROBING, point);
+        info.probing.add(probing[i] / 1000.);
 
-        point.setY((media + rtx + probing) / 1000.);
-        add_point(p.c_str(), StatKey::TOTAL, point);
-        info.total.update(point.y());
+        point.setY((media[i] + rtx[i] + probing[i]) / 1000.);
+        staged.add_point(StatKey::TOTAL, point);
+        info.total.add(point.y());
 
-        point.setY(recv/ 1000.);
-        add_point(p.c_str(), StatKey::RECEIVED_BITRATE, point);
-        info.received.update(recv/ 1000.);
+        point.setY(recv[i]/ 1000.);
+        staged.add_point(StatKey::RECEIVED_BITRATE, point);
+        info.received.add(recv[i]/ 1000.);
 
-        point.setY(target / 1000.);
-        add_point(p.c_str(), StatKey::TARGET, point);
-        info.target.update(target / 1000.);
+        point.setY(target[i] / 1000.);
+        staged.add_point(StatKey::TARGET, point);
+        info.target.add(target[i] / 1000.);
 
-        point.setY(rtt);
-        add_point(p.c_str(), StatKey::RTT, point);
-        info.rtt.update(rtt);
+        point.setY(rtt[i]);
+        staged.add_point(StatKey::RTT, point);
+        info.rtt.add(rtt[i]);
 
-        point.setY(minrtt);
-        add_point(p.c_str(), StatKey::MINRTT, point);
-        info.minrtt.update(minrtt);
+        point.setY(minrtt[i]);
+        staged.add_point(StatKey::MINRTT, point);
+        info.minrtt.add(minrtt[i]);
 
-        point.setY(fb_delay);
-        add_point(p.c_str(), StatKey::FBDELAY, point);
+        point.setY(fb_delay[i]);
+        staged.add_point(StatKey::FBDELAY, point);
 
         info.loss.sent++;
-        info.loss.loss = loss;
+        info.loss.loss = loss[i];
     }
 
+    info.summarize();
+
+    attach_points(exp, staged);
+
     QTreeWidgetItem * item = new QTreeWidgetItem(_info);
     item->setText(0, medooze_file.parent_path().filename().c_str());
 
-    process(p.c_str(), StatKey::MEDIA, item, info.media);
-    process(p.c_str(), StatKey::RTX, item, info.rtx);
-    process(p.c_str(), StatKey::PROBING, item, info.probing);
-    process(p.c_str(), StatKey::TOTAL, item, info.total);
-    process(p.c_str(), StatKey::RTT, item, info.rtt);
-    process(p.c_str(), StatKey::MINRTT, item, info.minrtt);
-    process(p.c_str(), StatKey::TARGET, item, info.target);
-    process(p.c_str(), StatKey::RECEIVED_BITRATE, item, info.received);
-    add_serie(p.c_str(), StatKey::FBDELAY);
+    process(exp, StatKey::MEDIA, item, info.media);
+    process(exp, StatKey::RTX, item, info.rtx);
+    process(exp, StatKey::PROBING, item, info.probing);
+    process(exp, StatKey::TOTAL, item, info.total);
+    process(exp, StatKey::RTT, item, info.rtt);
+    process(exp, StatKey::MINRTT, item, info.minrtt);
+    process(exp, StatKey::TARGET, item, info.target);
+    process(exp, StatKey::RECEIVED_BITRATE, item, info.received);
+    add_serie(exp, StatKey::FBDELAY);
     info.loss.process(item);
 
     _chart_bitrate->createDefaultAxes();
@@ -453,115 +555,112 @@ void MedoozeDisplay::load_average(const fs::path& p)
 }
 
 template<typename T>
-bool MedoozeDisplay::get_stats(const fs::path& p, std::ifstream& ifs, std::vector<StatLinePoint<T>>& tab, StatKey key)
+bool MedoozeDisplay::get_stats(Staged& staged, std::istream& ifs, std::vector<StatLinePoint>& tab, StatKey key)
 {
-    tab.emplace_back(StatLinePoint<T>{});
-    if(!get_csv_line(ifs, tab)) {
+    tab.emplace_back(StatLinePoint{});
+    if(!get_csv_line<T>(ifs, tab)) {
         tab.pop_back();
         return false;
     }
 
-    if(key != StatKey::RTT && key != StatKey::LOSS) {
-        for(int i = 0; i < tab.back().values.size(); ++i) tab.back().values[i] /= 1000.;
-    }
-
-    QPointF avg{(double)tab.back().time, get_average(tab.back().values)};
-    add_point(p.c_str(), key, avg);
-
-    StatKey key_box, key_inter;
-    switch(key) {
-    case StatKey::MEDIA:
-        key_box = StatKey::MEDIA_BOX;
-        key_inter= StatKey::MEDIA_INTERQUARTILE;
-        break;
-    case StatKey::TARGET:
-        key_box = StatKey::TARGET_BOX;
-        key_inter = StatKey::TARGET_INTERQUARTILE;
-        break;
-    case StatKey::RTT:
-        key_box = StatKey::RTT_BOX;
-        key_inter = StatKey::RTT_INTERQUARTILE;
-        break;
-    default:
-        return true;
-    }
+    if(key != StatKey::RTT && key != StatKey::LOSS) tab.back().stats.scale(1 / 1000.);
 
-    QPointF inter{(double)tab.back().time, get_interquartile_average(tab.back().values)};
-    add_point(p.c_str(), key_inter, inter);
-    add_point(p.c_str(), key_box, QString::number(tab.back().time), tab.back().values);
+    QPointF avg{(double)tab.back().time, tab.back().stats.mean};
+    staged.add_point(key, avg);
 
     return true;
 }
 
-void MedoozeDisplay::load_stat_line(const fs::path& p)
+DisplayBase::Attach MedoozeDisplay::parse_stat_line(const fs::path& p, std::stop_token stop)
 {
-    fs::path file = p / "stats_line_medooze.csv";
+    fs::path file = find_input(p / "stats_line_medooze.csv");
 
-    std::ifstream ifs(file.c_str());
+    InputStream ifs(file);
     if(!ifs.is_open()) {
         throw std::runtime_error("Could not open csv file with provided path : " + file.string());
     }
 
-    create_serie(p, StatKey::MEDIA);
-    create_serie(p, StatKey::PROBING);
-    create_serie(p, StatKey::RTX);
-    create_serie(p, StatKey::RTT);
-    create_serie(p, StatKey::TARGET);
-    create_serie(p, StatKey::RECEIVED_BITRATE);
-    create_serie(p, StatKey::LOSS);
-
-    create_serie(p, StatKey::MEDIA_INTERQUARTILE);
-    create_serie(p, StatKey::TARGET_INTERQUARTILE);
-    create_serie(p, StatKey::RTT_INTERQUARTILE);
-
-    create_serie<QBoxPlotSeries>(p, StatKey::MEDIA_BOX);
-    create_serie<QBoxPlotSeries>(p, StatKey::TARGET_BOX);
-    create_serie<QBoxPlotSeries>(p, StatKey::RTT_BOX);
-
-    std::vector<StatLinePoint<double>> media;
-    std::vector<StatLinePoint<double>> probing;
-    std::vector<StatLinePoint<double>> rtx;
-    std::vector<StatLinePoint<double>> rtt;
-    std::vector<StatLinePoint<double>> target;
-    std::vector<StatLinePoint<double>> recv;
-    std::vector<StatLinePoint<double>> loss;
+    Staged staged;
+
+    std::vector<StatLinePoint> media;
+    std::vector<StatLinePoint> probing;
+    std::vector<StatLinePoint> rtx;
+    std::vector<StatLinePoint> rtt;
+    std::vector<StatLinePoint> target;
+    std::vector<StatLinePoint> recv;
+    std::vector<StatLinePoint> loss;
 
     while(!ifs.eof()) {
-        if(!get_stats(p, ifs, media, StatKey::MEDIA)) break;
-        get_stats(p, ifs, probing, StatKey::PROBING);
-        get_stats(p, ifs, rtx, StatKey::RTX);
-        get_stats(p, ifs, target, StatKey::TARGET);
-        get_stats(p, ifs, recv, StatKey::RECEIVED_BITRATE);
-        get_stats(p, ifs, rtt, StatKey::RTT);
-        get_stats(p, ifs, loss, StatKey::LOSS);
+        if(stop.stop_requested()) return {};
+
+        if(!get_stats<double>(staged, ifs, media, StatKey::MEDIA)) break;
+        get_stats<double>(staged, ifs, probing, StatKey::PROBING);
+        get_stats<double>(staged, ifs, rtx, StatKey::RTX);
+        get_stats<double>(staged, ifs, target, StatKey::TARGET);
+        get_stats<double>(staged, ifs, recv, StatKey::RECEIVED_BITRATE);
+        get_stats<double>(staged, ifs, rtt, StatKey::RTT);
+        get_stats<double>(staged, ifs, loss, StatKey::LOSS);
     }
 
-    add_serie(p.c_str(), StatKey::MEDIA);
-    add_serie(p.c_str(), StatKey::PROBING);
-    add_serie(p.c_str(), StatKey::RTX);
-    add_serie(p.c_str(), StatKey::TARGET);
-    add_serie(p.c_str(), StatKey::RECEIVED_BITRATE);
-    add_serie(p.c_str(), StatKey::LOSS);
+    staged.index();
+
+    // the interquartile means and boxes are only computed when shown
+    return [this, p, staged = std::move(staged), media = share_rows(std::move(media)),
+            target = share_rows(std::move(target)), rtt = share_rows(std::move(rtt))]() {
+        auto exp = experiment(p);
+
+        create_serie(exp, StatKey::MEDIA);
+        create_serie(exp, StatKey::PROBING);
+        create_serie(exp, StatKey::RTX);
+        create_serie(exp, StatKey::RTT);
+        create_serie(exp, StatKey::TARGET);
+        create_serie(exp, StatKey::RECEIVED_BITRATE);
+        create_serie(exp, StatKey::LOSS);
+
+        attach_points(exp, staged);
+
+        add_serie(exp, StatKey::MEDIA);
+        add_serie(exp, StatKey::PROBING);
+        add_serie(exp, StatKey::RTX);
+        add_serie(exp, StatKey::TARGET);
+        add_serie(exp, StatKey::RECEIVED_BITRATE);
+        add_serie(exp, StatKey::LOSS);
+
+        defer_stat_line(exp, media, StatKey::MEDIA_INTERQUARTILE, StatKey::MEDIA_BOX);
+        defer_stat_line(exp, target, StatKey::TARGET_INTERQUARTILE, StatKey::TARGET_BOX);
+        defer_stat_line(exp, rtt, StatKey::RTT_INTERQUARTILE, StatKey::RTT_BOX);
+    };
+}
+
+DisplayBase::Attach MedoozeDisplay::parse(const fs::path& p, const ExperimentCatalog* catalog, std::stop_token stop)
+{
+    if(stop.stop_requested()) return {};
 
-    add_serie(p.c_str(), StatKey::MEDIA_INTERQUARTILE);
-    add_serie(p.c_str(), StatKey::TARGET_INTERQUARTILE);
-    add_serie(p.c_str(), StatKey::RTT_INTERQUARTILE);
+    Attach attach;
+    if(p.filename().string() == "average") attach = parse_stat_line(p, stop); // load_average(p);
+    else attach = parse_exp(p, catalog, stop);
 
-    // add_serie<QBoxPlotSeries>(p.c_str(), StatKey::MEDIA_BOX);
-    // add_serie<QBoxPlotSeries>(p.c_str(), StatKey::TARGET_BOX);
-    // add_serie<QBoxPlotSeries>(p.c_str(), StatKey::RTT_BOX);
+    if(!attach) return {};
 
-    _chart_bitrate->createDefaultAxes();
-    _chart_rtt->createDefaultAxes();
+    return [this, p, attach = std::move(attach)]() {
+        attach();
+        set_makeup(p);
+        update_charts();
+        // _chart_view_bitrate->hide();
+    };
 }
 
 void MedoozeDisplay::load(const fs::path& p)
 {
-    if(p.filename().string() == "average") load_stat_line(p); // load_average(p);
-    else load_exp(p);
+    if(auto attach = parse(p, _catalog.get())) attach();
+}
 
-    set_makeup(p);
-    // _chart_view_bitrate->hide();
+void MedoozeDisplay::unload(const fs::path& p)
+{
+    _max_loss.remove(p.c_str());
+    _packet_files.remove(p.c_str());
+    _info_items.remove(p.c_str());
+    DisplayBase::unload(p);
 }
 
 void MedoozeDisplay::save(const fs::path& dir)
@@ -575,15 +674,17 @@ void MedoozeDisplay::save(const fs::path& dir)
 
 void MedoozeDisplay::add_to_all(const fs::path& dir, AllBitrateDisplay* all)
 {
-    auto& map = _path_keys[dir.c_str()];
-    // all->add_stats(dir, AllBitrateDisplay::TARGET, map[TARGET]);
-    // all->add_stats(dir, AllBitrateDisplay::PROBING, map[PROBING]);
-    // all->add_stats(dir, AllBitrateDisplay::MEDIA, map[MEDIA]);
-    // all->add_stats(dir, AllBitrateDisplay::TOTAL, map[TOTAL]);
-    // all->add_stats(dir, AllBitrateDisplay::RTX, map[RTX]);
-    // all->add_stats(dir, AllBitrateDisplay::MEDOOZE_RTT, map[RTT]);
-    // all->add_stats(dir, AllBitrateDisplay::MEDOOZE_LOSS, map[LOSS]);
-    // all->add_stats(dir, AllBitrateDisplay::MEDOOZE_LOSS, map[LOSS_ACCUMULATED]);
+    auto exp = find_experiment(dir);
+    if(!exp) return;
+
+    // all->add_stats(dir, AllBitrateDisplay::TARGET, (*exp)[TARGET]);
+    // all->add_stats(dir, AllBitrateDisplay::PROBING, (*exp)[PROBING]);
+    // all->add_stats(dir, AllBitrateDisplay::MEDIA, (*exp)[MEDIA]);
+    // all->add_stats(dir, AllBitrateDisplay::TOTAL, (*exp)[TOTAL]);
+    // all->add_stats(dir, AllBitrateDisplay::RTX, (*exp)[RTX]);
+    // all->add_stats(dir, AllBitrateDisplay::MEDOOZE_RTT, (*exp)[RTT]);
+    // all->add_stats(dir, AllBitrateDisplay::MEDOOZE_LOSS, (*exp)[LOSS]);
+    // all->add_stats(dir, AllBitrateDisplay::MEDOOZE_LOSS, (*exp)[LOSS_ACCUMULATED]);
 }
 
 void MedoozeDisplay::set_geometry(float ratio_w, float ratio_h)
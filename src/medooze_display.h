@@ -9,9 +9,16 @@
 #include <QLineSeries>
 #include <QChart>
 
+#include <atomic>
 #include <filesystem>
+#include <future>
+#include <memory>
+#include <stop_token>
+#include <vector>
 
 #include "display_base.h"
+#include "rate_window.h"
+#include "percentiles.h"
 
 namespace fs = std::filesystem;
 
@@ -70,25 +77,21 @@ public:
         TARGET_INTERQUARTILE,
     };
 
+    static_assert(StatKey::TARGET_INTERQUARTILE < MAX_KEYS);
+
     struct Info
     {
-        struct Stats
+        // the percentiles of the sampled ones are shown too
+        struct Stats : SampledStats
         {
-            double mean = 0.;
-            double variance = 0.;
-            double var_coeff = 0.;
-            uint64_t n = 0;
             QString name;
 
-            explicit Stats(QString&& in_name) : name(std::move(in_name)) {}
-
-            void update(double value) {
-                ++n;
-                mean += value;
-                variance += (value * value);
-            }
+            explicit Stats(QString&& in_name, bool sampled = false) : SampledStats(sampled), name(std::move(in_name)) {}
 
             void process(QTreeWidgetItem* root);
+
+            // Replace the children of item by these stats
+            void fill(QTreeWidgetItem* item) const;
         };
 
         struct StatsLoss
@@ -107,52 +110,95 @@ public:
             void process(QTreeWidgetItem* root);
         };
 
-        Stats rtt{"rtt"};
-        Stats minrtt{"minrtt"};
+        Stats rtt{"rtt", true};
+        Stats minrtt{"minrtt", true};
         Stats target{"Target"};
         Stats media{"Media"};
         Stats rtx{"rtx"};
         Stats probing{"probing"};
-        Stats total{"total"};
-        Stats received{"received"};
+        Stats total{"total", true};
+        Stats received{"received", true};
         StatsLoss loss{"loss"};
+
+        // Select the percentiles, once every value is added
+        void summarize()
+        {
+            for(auto* stats : { &rtt, &minrtt, &target, &media, &rtx, &probing, &total, &received }) stats->summarize();
+        }
     };
 
-    void load_stat_line(const fs::path& p);
+    Attach parse_stat_line(const fs::path& p, std::stop_token stop);
 
     template<typename T>
-    bool get_stats(const fs::path& p, std::ifstream& ifs, std::vector<StatLinePoint<T>>& tab, StatKey key);
+    static bool get_stats(Staged& staged, std::istream& ifs, std::vector<StatLinePoint>& tab, StatKey key);
 
-    void set_makeup(const fs::path& path);
+    void set_makeup(const fs::path& path) override;
 
  private:
 
     StatsLineChart * _chart_bitrate, * _chart_rtt;
     StatsLineChartView* _chart_view_bitrate, * _chart_view_rtt;
 
-    void init_map(StatMap& map, bool signal = true) override;
+    QMap<QString, double> _max_loss;  // of the loaded experiments
 
-    template<Processable Stat>
-    void process(QTreeWidgetItem* root, Stat& stat, const fs::path& p, StatKey key, const QList<QPointF>& points) {
-        stat.process(root);
-        add_point(p.c_str(), key, points);
-        add_serie(p.c_str(), key);
-    }
+    // medooze.csv of the experiments loaded packet by packet
+    QMap<QString, fs::path> _packet_files;
+
+    // info tree entry of each of them, its rate stats follow the window
+    QMap<QString, QTreeWidgetItem*> _info_items;
+
+    // read by the parses in the background
+    std::atomic<RateWindow> _rate_window{RateWindow::MS_200};
+
+    // Per packet series of medooze.csv, the rates over window. false if
+    // stop was requested meanwhile.
+    static bool stage_packets(const fs::path& path, RateWindow window, Staged& staged, Info& info, std::stop_token stop);
+
+    // Packet series of an experiment recomputed for another window
+    struct Rates
+    {
+        Staged staged;
+        Info info;
+        double max_loss = 0.;
+    };
+
+    // recomputations of the rates, stopped when the window changes again
+    // and waited for by the destructor since they post to this display
+    std::stop_source _rates_stop;
+    std::vector<std::future<void>> _rates;
+
+    // experiments of the latest recomputation not back yet, the charts are
+    // refreshed once they all are
+    size_t _rates_pending = 0;
+
+    // GUI thread, once the rates of p are staged. rates is null when they
+    // could not be computed.
+    void on_rates_staged(const QString& p, const fs::path& path, const std::stop_source& stop, std::shared_ptr<const Rates> rates);
+
+    void init_map(Experiment& exp) override;
+    void refresh_charts() override;
 
     template<Processable Stat>
-    void process(const fs::path& p, StatKey key, QTreeWidgetItem* root, Stat& stat) {
+    void process(ExpHandle exp, StatKey key, QTreeWidgetItem* root, Stat& stat) {
         stat.process(root);
-        add_serie(p.c_str(), key);
+        add_serie(exp, key);
     }
 
     void load_average(const fs::path& path);
-    void load_exp(const fs::path& path);
+    Attach parse_exp(const fs::path& path, const ExperimentCatalog* catalog, std::stop_token stop);
 
 public:
     MedoozeDisplay(QWidget* tab, QVBoxLayout* layout, QListWidget* legend, QTreeWidget* info);
-    ~MedoozeDisplay() = default;
+    ~MedoozeDisplay();
 
     void load(const fs::path& path) override;
+    void unload(const fs::path& path) override;
+    Attach parse(const fs::path& path, const ExperimentCatalog* catalog, std::stop_token stop = {}) override;
+
+    // Parse the result files of experiment p into their column cache,
+    // without touching any widget. Safe to call from any thread.
+    static void warm_cache(const fs::path& p);
+
     void save(const fs::path& dir) override;
 
     void add_to_all(const fs::path& dir, AllBitrateDisplay* all);
@@ -160,6 +206,10 @@ public:
 
     void on_keyboard_event(QKeyEvent* key);
 
+    // Compute the rates of the loaded experiments again, W cycles through
+    // the windows
+    void set_rate_window(RateWindow window);
+
 signals:
     void on_loss_stats(const fs::path& path, int loss, int sent);
 };
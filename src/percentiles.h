@@ -0,0 +1,95 @@
+#ifndef PERCENTILES_H
+#define PERCENTILES_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "running_stats.h"
+
+// Percentiles shown in the info panels, in per mille so that their ranks
+// are computed exactly
+constexpr std::array<size_t, 5> PERCENTILES_PER_MILLE{ 500, 900, 950, 990, 999 };
+
+using Percentiles = std::array<double, PERCENTILES_PER_MILLE.size()>;
+
+// Exact PERCENTILES_PER_MILLE of values, nearest rank. The ranks are
+// selected in increasing order, each one among the values right of the
+// previous one, so the whole costs about one std::nth_element over values.
+// values are reordered.
+template<typename T>
+Percentiles select_percentiles(std::span<T> values)
+{
+    Percentiles result;
+    result.fill(std::numeric_limits<double>::quiet_NaN());
+
+    if(values.empty()) return result;
+
+    size_t selected = 0;
+
+    for(size_t i = 0; i < PERCENTILES_PER_MILLE.size(); ++i) {
+        // smallest rank with at least p of the values at or below it
+        size_t rank = (PERCENTILES_PER_MILLE[i] * values.size() + 999) / 1000;
+        rank = std::max<size_t>(rank, 1) - 1;
+
+        if(rank >= selected) {
+            std::nth_element(values.begin() + selected, values.begin() + rank, values.end());
+            selected = rank + 1;
+        }
+
+        result[i] = values[rank];
+    }
+
+    return result;
+}
+
+// RunningStats that also keeps the values, if asked to, until their
+// percentiles are selected
+class SampledStats : public RunningStats
+{
+    bool _sampled;
+    std::vector<double> _values;
+    Percentiles _percentiles;
+
+public:
+    explicit SampledStats(bool sampled = true) : _sampled(sampled)
+    {
+        _percentiles.fill(std::numeric_limits<double>::quiet_NaN());
+    }
+
+    void add(double value)
+    {
+        RunningStats::add(value);
+        if(_sampled) _values.push_back(value);
+    }
+
+    // both sampled or both not, the values of one side would be missing
+    // from the percentiles otherwise
+    void merge(const SampledStats& other)
+    {
+        assert(_sampled == other._sampled);
+
+        RunningStats::merge(other);
+        if(_sampled) _values.insert(_values.end(), other._values.begin(), other._values.end());
+    }
+
+    bool sampled() const { return _sampled; }
+
+    // Select the percentiles once every value is added, and release them
+    void summarize()
+    {
+        if(!_sampled) return;
+
+        _percentiles = select_percentiles(std::span<double>(_values));
+        _values = {};
+    }
+
+    // NaN before summarize
+    const Percentiles& percentiles() const { return _percentiles; }
+};
+
+#endif // PERCENTILES_H
@@ -1,5 +1,7 @@
 #include <iostream>
 #include <fstream>
+#include <numeric>
+#include <algorithm>
 
 #include <QTabWidget>
 #include <QListWidget>
@@ -12,6 +14,10 @@
 #include "qlog_display.h"
 #include "stats_line_chart.h"
 #include "csv_reader.h"
+#include "input_file.h"
+#include "qlog_parser.h"
+#include "column_cache.h"
+#include "thread_pool.h"
 
 #include "all_bitrate.h"
 
@@ -46,9 +52,10 @@ void QlogDisplay::on_keyboard_event(QKeyEvent* key)
         else _chart_view_bitrate->hide();
         break;
     case Qt::Key_R: {
-        for(auto& map : _path_keys) {
-            // auto& map = _path_keys[p.c_str()];
-            auto serie = static_cast<QLineSeries*>(std::get<StatsKeyProperty::SERIE>(map[StatKey::DISTRIBUTION]));
+        for(auto& [_, exp] : _experiments) {
+            auto serie = static_cast<QLineSeries*>((*exp)[StatKey::DISTRIBUTION].serie);
+            if(!serie) continue;
+
             auto w = new DistributionWidget(serie);
             w->show();
         }
@@ -57,39 +64,50 @@ void QlogDisplay::on_keyboard_event(QKeyEvent* key)
     }
 }
 
-void QlogDisplay::init_map(StatMap& map, bool signal)
+void QlogDisplay::init_map(Experiment& exp)
 {
-    map[StatKey::CWND] = std::make_tuple("Cwnd", nullptr, _chart_bitrate, ExpInfo{.stream = false}, false);
-    map[StatKey::BYTES_IN_FLIGHT] = std::make_tuple("Bytes in flight", nullptr, _chart_bitrate, ExpInfo{.stream = false}, false);
-    map[StatKey::RTT] = std::make_tuple("RTT", nullptr, _chart_rtt, ExpInfo{.stream = false}, false);
-    map[StatKey::LOSS] = std::make_tuple("Loss", nullptr, _chart_bitrate, ExpInfo{.stream = false}, false);
+    exp.declare(StatKey::CWND, {"Cwnd", nullptr, _chart_bitrate, ExpInfo{.stream = false}, false});
+    exp.declare(StatKey::BYTES_IN_FLIGHT, {"Bytes in flight", nullptr, _chart_bitrate, ExpInfo{.stream = false}, false});
+    exp.declare(StatKey::RTT, {"RTT", nullptr, _chart_rtt, ExpInfo{.stream = false}, false});
+    exp.declare(StatKey::LOSS, {"Loss", nullptr, _chart_bitrate, ExpInfo{.stream = false}, false});
+
+    exp.declare(StatKey::CWND_BOX, {"Cwnd box", nullptr, _chart_bitrate, ExpInfo{.stream = false}, false});
+    exp.declare(StatKey::BYTES_IN_FLIGHT_BOX, {"Bytes in flight box", nullptr, _chart_bitrate, ExpInfo{.stream = false}, false});
+    exp.declare(StatKey::RTT_BOX, {"RTT box", nullptr, _chart_rtt, ExpInfo{.stream = false}, false});
+
+    exp.declare(StatKey::CWND_INTERQUARTILE, {"Cwnd", nullptr, _chart_bitrate, ExpInfo{.stream = false}, false});
+    exp.declare(StatKey::BYTES_IN_FLIGHT_INTERQUARTILE, {"Bytes in flight", nullptr, _chart_bitrate, ExpInfo{.stream = false}, false});
+    exp.declare(StatKey::RTT_INTERQUARTILE, {"RTT", nullptr, _chart_rtt, ExpInfo{.stream = false}, false});
+}
 
-    map[StatKey::CWND_BOX] = std::make_tuple("Cwnd box", nullptr, _chart_bitrate, ExpInfo{.stream = false}, false);
-    map[StatKey::BYTES_IN_FLIGHT_BOX] = std::make_tuple("Bytes in flight box", nullptr, _chart_bitrate, ExpInfo{.stream = false}, false);
-    map[StatKey::RTT_BOX] = std::make_tuple("RTT box", nullptr, _chart_rtt, ExpInfo{.stream = false}, false);
+void QlogDisplay::set_makeup(const fs::path& path)
+{
+    auto exp = find_experiment(path);
+    if(!exp) return;
 
-    map[StatKey::CWND_INTERQUARTILE] = std::make_tuple("Cwnd", nullptr, _chart_bitrate, ExpInfo{.stream = false}, false);
-    map[StatKey::BYTES_IN_FLIGHT_INTERQUARTILE] = std::make_tuple("Bytes in flight", nullptr, _chart_bitrate, ExpInfo{.stream = false}, false);
-    map[StatKey::RTT_INTERQUARTILE] = std::make_tuple("RTT", nullptr, _chart_rtt, ExpInfo{.stream = false}, false);
+    for(const auto& [name, abs_serie, chart, info, show] : exp->slots()) {
+        auto* serie = dynamic_cast<QLineSeries*>(abs_serie);
+        if(!serie) continue;
 
-    if(signal) {
-        connect(_legend, &QListWidget::itemChanged, this, [&map](QListWidgetItem* item) -> void {
-            StatKey key = static_cast<StatKey>(item->data(1).toUInt());
+        auto pen = serie->pen();
+        pen.setWidth(6);
 
-            std::get<StatsKeyProperty::SHOW>(map[(uint8_t)key]) = item->checkState() == Qt::Checked;
+        QColor color = get_color(info);
+        pen.setColor(color);
 
-            auto line = std::get<StatsKeyProperty::SERIE>(map[key]);
-            if(line == nullptr) return;
+        if(name == "Bytes in flight") {
+            pen.setWidth(4);
+            pen.setStyle(Qt::DashLine);
+        }
 
-            if(item->checkState() == Qt::Checked) line->show();
-            else line->hide();
-        });
+        serie->setPen(pen);
     }
 }
 
-void QlogDisplay::set_makeup(const fs::path& path)
+void QlogDisplay::refresh_charts()
 {
-    const auto& map = _path_keys[path.c_str()];
+    _chart_bitrate->createDefaultAxes();
+    _chart_rtt->createDefaultAxes();
 
     QFont font = _chart_bitrate->font();
     font.setPointSize(40);
@@ -103,24 +121,6 @@ void QlogDisplay::set_makeup(const fs::path& path)
     _chart_rtt->legend()->setFont(font);
     _chart_rtt->legend()->detachFromChart();
 
-    for(const auto& [name, abs_serie, chart, info, show] : map) {
-        auto* serie = dynamic_cast<QLineSeries*>(abs_serie);
-        if(!serie) continue;
-
-        auto pen = serie->pen();
-        pen.setWidth(6);
-
-        QColor color = get_color(info);
-        pen.setColor(color);
-
-        if(name == "Bytes in flight") {
-            pen.setWidth(4);
-            pen.setStyle(Qt::DashLine);
-        }
-
-        serie->setPen(pen);
-    }
-
     auto setup_axes = [&font](auto&& axe,const std::string& name) {
         axe->setTitleText(name.c_str());
 
@@ -169,273 +169,362 @@ void QlogDisplay::add_info(const fs::path& path, const Info& info)
 
     QTreeWidgetItem * rtt = new QTreeWidgetItem(item);
     rtt->setText(0, "RTT mean");
-    rtt->setText(1, QString::number(info.mean_rtt));
+    rtt->setText(1, QString::number(info.rtt.mean()));
 
     QTreeWidgetItem * variance = new QTreeWidgetItem(item);
     variance->setText(0, "RTT variance");
-    variance->setText(1, QString::number(info.variance_rtt));
+    variance->setText(1, QString::number(info.rtt.variance()));
+
+    add_percentiles(item, "RTT", info.rtt.percentiles());
 }
 
-void QlogDisplay::parse_mvfst(const fs::path& path)
+namespace
 {
-    std::ifstream qlog_file(path);
-    auto qlog_data = json::parse(qlog_file);
 
-    int64_t time_0 = -1;
-    uint64_t sum = 0;
+// mvfst writes a single json document, the other implementations NDJSON
+enum class QlogDialect
+{
+    UNKNOWN,
+    MVFST,
+    NDJSON
+};
 
-    Info info{};
-    memset(&info, 0, sizeof(info));
+constexpr qlog::EventMask bit(qlog::EventName name)
+{
+    return 1u << name;
+}
 
-    fs::path key = path.parent_path();
+// events handled by parse_mvfst and parse_quicgo
+constexpr qlog::EventMask MVFST_EVENTS = bit(qlog::METRICS_UPDATED) | bit(qlog::LOSS_PACKETS_LOST) | bit(qlog::PACKET_SENT);
+constexpr qlog::EventMask NDJSON_EVENTS = bit(qlog::METRICS_UPDATED) | bit(qlog::TRANSPORT_PACKET_LOST)
+                                          | bit(qlog::RECOVERY_PACKET_LOST) | bit(qlog::PACKET_SENT);
 
-    for(auto& trace : qlog_data["traces"]) {
-        for(auto& event : trace["events"]) {
-            auto name = event["name"].get<std::string>();
+fs::path find_qlog(const ExperimentCatalog* catalog, const fs::path& p)
+{
+    return find_data_file(catalog, p, [](const fs::path& file) {
+        return strip_compression(file).extension() == ".qlog";
+    });
+}
 
-            if(time_0 == -1) time_0 = event["time"].get<int64_t>();
-            int64_t time = event["time"].get<int64_t>() - time_0;
+QlogDialect dialect_of(const fs::path& path)
+{
+    auto impl = path.parent_path().filename().string();
+    auto name = path.filename().string();
 
-            if(name == "recovery:metrics_updated") {
-                try {
-                    auto data = event["data"];
+    if(name.starts_with("mvfst") || impl.starts_with("mvfst")) return QlogDialect::MVFST;
 
-                    QPointF p_cwnd{time/1000000.f, data["congestion_window"].get<float>() / 1000.f};
-                    QPointF p_bif{time/1000000.f, data["bytes_in_flight"].get<float>() / 1000.f};
-                    QPointF p_distrib{time/1000000.f, p_cwnd.y() / p_bif.y()};
+    for(const char* prefix : { "quicgo", "quiche", "msquic" }) {
+        if(name.starts_with(prefix) || impl.starts_with(prefix)) return QlogDialect::NDJSON;
+    }
 
-                    add_point(key.c_str(), StatKey::CWND, p_cwnd);
-                    add_point(key.c_str(), StatKey::BYTES_IN_FLIGHT, p_bif);
-                    add_point(key.c_str(), StatKey::DISTRIBUTION, p_distrib);
-                } catch(...) { }
+    return QlogDialect::UNKNOWN;
+}
 
-                try {
-                    // if(time_0 == -1) time_0 = event["time"].get<int64_t>();
-                    // int64_t time = event["time"].get<int64_t>() - time_0;
+// Handled events of a qlog, from its cache when valid
+qlog::EventColumns read_qlog(const fs::path& path, QlogDialect dialect)
+{
+    if(dialect == QlogDialect::MVFST) {
+        return column_cache::load<qlog::EventColumns>(path, "qlog:mvfst " + qlog::columns_schema(MVFST_EVENTS), [&path](bool& cacheable) {
+            qlog::EventColumns events;
 
-                    auto data = event["data"];
+            InputStream qlog_file(path);
+            if(!qlog::parse_mvfst(qlog_file, MVFST_EVENTS, events)) {
+                std::cout << "Malformed mvfst qlog, stopped at the first error : " << path << std::endl;
 
-                    float rtt = data["latest_rtt"].get<float>();
-                    QPointF p_rtt{time/1000000.f, rtt};
-                    add_point(key.c_str(), StatKey::RTT, p_rtt);
+                // parsed again next time, with the same warning
+                cacheable = false;
+            }
 
-                    info.mean_rtt += rtt;
-                    info.variance_rtt += (rtt * rtt);
+            return events;
+        });
+    }
 
-                    ++sum;
-                } catch(...) {}
-            }
-            else if(name == "loss:packets_lost") {
-                add_point(key.c_str(), StatKey::LOSS, QPointF(time / 1000000.f, info.lost));
-                info.lost += event["data"]["lost_packets"].get<int>();
-                add_point(key.c_str(), StatKey::LOSS, QPointF(time / 1000000.f, info.lost));
-            }
-            else if(name == "transport:packet_sent") {
-                ++info.sent;
+    return column_cache::load<qlog::EventColumns>(path, "qlog:ndjson " + qlog::columns_schema(NDJSON_EVENTS), [&path]() {
+        return qlog::parse_ndjson(path, NDJSON_EVENTS);
+    });
+}
+
+// RTT of the metrics updates, LATEST_RTT or else SMOOTHED_RTT when
+// fallback. Chunks of the columns are reduced on the pool then merged.
+SampledStats rtt_stats(const qlog::EventColumns& events, bool fallback)
+{
+    static constexpr size_t CHUNK_EVENTS = 1 << 16;
+
+    auto& pool = ThreadPool::global();
+
+    std::vector<std::future<SampledStats>> pending;
+    for(size_t begin = 0; begin < events.size(); begin += CHUNK_EVENTS) {
+        pending.push_back(pool.submit([&events, fallback, begin]() {
+            SampledStats stats;
+
+            size_t end = std::min(begin + CHUNK_EVENTS, events.size());
+            for(size_t i = begin; i < end; ++i) {
+                if(events.name[i] != qlog::METRICS_UPDATED) continue;
+
+                uint32_t present = events.present[i];
+                if(present & (1u << qlog::LATEST_RTT)) stats.add(static_cast<float>(events.data[qlog::LATEST_RTT][i]));
+                else if(fallback && (present & (1u << qlog::SMOOTHED_RTT))) stats.add(static_cast<float>(events.data[qlog::SMOOTHED_RTT][i]));
             }
-        }
+
+            return stats;
+        }));
     }
 
-    info.mean_rtt /= sum;
-    info.variance_rtt = (info.variance_rtt / sum) - (info.mean_rtt * info.mean_rtt);
+    pool.wait(pending);
 
-    add_info(path, info);
+    SampledStats stats;
+    for(auto& f : pending) stats.merge(f.get());
 
-    emit on_loss_stats(key, info.lost, info.sent);
+    stats.summarize();
+    return stats;
 }
 
-void QlogDisplay::parse_quicgo(const fs::path& path)
+}
+
+bool QlogDisplay::parse_mvfst(const fs::path& path, Staged& staged, Info& info, std::stop_token stop)
 {
-    std::ifstream ifs(path);
-    std::string line;
+    // time origin is the first event of the trace, handled or not, set
+    // once the events are read
+    int64_t time_0 = 0;
 
-    Info info{};
-    uint64_t sum = 0;
-    memset(&info, 0, sizeof(info));
-
-    fs::path key = path.parent_path();
-
-    while(std::getline(ifs, line)) {
-        auto pos = line.find("{");
-
-        auto line_json = json::parse(line.substr(pos));
-
-        try {
-            auto name = line_json["name"].get<std::string>();
-            auto time = line_json["time"].get<float>() / 1000.f;
-
-            if(name == "recovery:metrics_updated") {
-                auto data = line_json["data"];
-
-                QPointF p_cwnd;
-                if(data.contains("congestion_window")) {
-                    p_cwnd = QPointF{time, data["congestion_window"].get<float>() / 1000.};
-                    add_point(key.c_str(), StatKey::CWND, p_cwnd);
-                }
-
-                if(data.contains("bytes_in_flight")) {
-                    QPointF p_bif{time, data["bytes_in_flight"].get<float>() / 1000.};
-                    add_point(key.c_str(), StatKey::BYTES_IN_FLIGHT, p_bif);
-
-                    QPointF p_distrib{time/1000000.f, p_cwnd.y() / p_bif.y()};
-                    add_point(key.c_str(), StatKey::DISTRIBUTION, p_distrib);
-                }
-
-                if(data.contains("latest_rtt")) {
-                    float rtt = data["latest_rtt"].get<float>();
-                    QPointF p_rtt{time, rtt};
-                    add_point(key.c_str(), StatKey::RTT, p_rtt);
-                    info.mean_rtt += rtt;
-                    info.variance_rtt += (rtt * rtt);
-
-                    ++sum;
-                }
-                else if(data.contains("smoothed_rtt")) {
-                    float rtt = data["smoothed_rtt"].get<float>();
-                    QPointF p_rtt{time, rtt};
-                    add_point(key.c_str(), StatKey::RTT, p_rtt);
-                    info.mean_rtt += rtt;
-                    info.variance_rtt += (rtt * rtt);
-
-                    ++sum;
-                }
-
-                if(data.contains("lost_packets")) {
-                    add_point(key.c_str(), StatKey::LOSS, QPointF(time, info.lost));
-                    info.lost = data["lost_packets"].get<int>();
-                    add_point(key.c_str(), StatKey::LOSS, QPointF(time, info.lost));
-                }
-                if(data.contains("total_send_packets")) {
-                    info.sent = data["total_send_packets"].get<int>();
-                }
-            }
-            else if(name == "transport:packet_lost" || name == "recovery:packet_lost" ) {
-                add_point(key.c_str(), StatKey::LOSS, QPointF(time, info.lost));
-                ++info.lost;
-                add_point(key.c_str(), StatKey::LOSS, QPointF(time, info.lost));
-            }
-            else if(name == "transport:packet_sent") {
-                ++info.sent;
-            }
-        } catch(...) {}
-    }
+    auto time_of = [&time_0](const qlog::Event& event) {
+        return static_cast<int64_t>(event.time) - time_0;
+    };
+
+    qlog::HandlerTable handlers{};
+
+    handlers[qlog::METRICS_UPDATED] = [&](const qlog::Event& event) {
+        int64_t time = time_of(event);
+
+        if(event.has(qlog::CONGESTION_WINDOW) && event.has(qlog::BYTES_IN_FLIGHT)) {
+            QPointF p_cwnd{time/1000000.f, event.get(qlog::CONGESTION_WINDOW) / 1000.f};
+            QPointF p_bif{time/1000000.f, event.get(qlog::BYTES_IN_FLIGHT) / 1000.f};
+            QPointF p_distrib{time/1000000.f, p_cwnd.y() / p_bif.y()};
+
+            staged.add_point(StatKey::CWND, p_cwnd);
+            staged.add_point(StatKey::BYTES_IN_FLIGHT, p_bif);
+            staged.add_point(StatKey::DISTRIBUTION, p_distrib);
+        }
+
+        if(event.has(qlog::LATEST_RTT)) {
+            float rtt = event.get(qlog::LATEST_RTT);
+            QPointF p_rtt{time/1000000.f, rtt};
+            staged.add_point(StatKey::RTT, p_rtt);
+        }
+    };
+
+    handlers[qlog::LOSS_PACKETS_LOST] = [&](const qlog::Event& event) {
+        int64_t time = time_of(event);
+        if(!event.has(qlog::LOST_PACKETS)) return;
+
+        staged.add_point(StatKey::LOSS, QPointF(time / 1000000.f, info.lost));
+        info.lost += static_cast<int>(event.get(qlog::LOST_PACKETS));
+        staged.add_point(StatKey::LOSS, QPointF(time / 1000000.f, info.lost));
+    };
+
+    handlers[qlog::PACKET_SENT] = [&](const qlog::Event&) {
+        ++info.sent;
+    };
 
-    info.mean_rtt /= sum;
-    info.variance_rtt = (info.variance_rtt / sum) - (info.mean_rtt * info.mean_rtt);
+    const auto events = read_qlog(path, QlogDialect::MVFST);
+    if(stop.stop_requested()) return false;
 
-    add_info(path, info);
+    time_0 = static_cast<int64_t>(events.origin());
+    info.rtt = rtt_stats(events, false);
 
-    emit on_loss_stats(key, info.lost, info.sent);
+    // at most one point per metrics update in the line series
+    auto metrics = std::count(events.name.begin(), events.name.end(), qlog::METRICS_UPDATED);
+    for(auto key : { StatKey::CWND, StatKey::BYTES_IN_FLIGHT, StatKey::DISTRIBUTION, StatKey::RTT }) staged.reserve(key, metrics);
+
+    for(size_t i = 0; i < events.size(); ++i) {
+        qlog::dispatch(handlers, events.at(i));
+    }
+
+    return true;
 }
 
-void QlogDisplay::load_exp(const fs::path& p)
+bool QlogDisplay::parse_quicgo(const fs::path& path, Staged& staged, Info& info, std::stop_token stop)
 {
-    fs::path path;
-    for (auto const& dir_entry : std::filesystem::recursive_directory_iterator{p}) {
-        if(dir_entry.path().extension() == ".qlog") {
-            path = dir_entry.path();
-            break;
+    qlog::HandlerTable handlers{};
+
+    handlers[qlog::METRICS_UPDATED] = [&](const qlog::Event& event) {
+        float time = event.time / 1000.f;
+
+        QPointF p_cwnd;
+        if(event.has(qlog::CONGESTION_WINDOW)) {
+            p_cwnd = QPointF{time, event.get(qlog::CONGESTION_WINDOW) / 1000.};
+            staged.add_point(StatKey::CWND, p_cwnd);
+        }
+
+        if(event.has(qlog::BYTES_IN_FLIGHT)) {
+            QPointF p_bif{time, event.get(qlog::BYTES_IN_FLIGHT) / 1000.};
+            staged.add_point(StatKey::BYTES_IN_FLIGHT, p_bif);
+
+            QPointF p_distrib{time/1000000.f, p_cwnd.y() / p_bif.y()};
+            staged.add_point(StatKey::DISTRIBUTION, p_distrib);
+        }
+
+        if(event.has(qlog::LATEST_RTT) || event.has(qlog::SMOOTHED_RTT)) {
+            float rtt = event.get(event.has(qlog::LATEST_RTT) ? qlog::LATEST_RTT : qlog::SMOOTHED_RTT);
+            QPointF p_rtt{time, rtt};
+            staged.add_point(StatKey::RTT, p_rtt);
         }
+
+        if(event.has(qlog::LOST_PACKETS)) {
+            staged.add_point(StatKey::LOSS, QPointF(time, info.lost));
+            info.lost = static_cast<int>(event.get(qlog::LOST_PACKETS));
+            staged.add_point(StatKey::LOSS, QPointF(time, info.lost));
+        }
+        if(event.has(qlog::TOTAL_SEND_PACKETS)) {
+            info.sent = static_cast<int>(event.get(qlog::TOTAL_SEND_PACKETS));
+        }
+    };
+
+    auto on_packet_lost = [&](const qlog::Event& event) {
+        float time = event.time / 1000.f;
+
+        staged.add_point(StatKey::LOSS, QPointF(time, info.lost));
+        ++info.lost;
+        staged.add_point(StatKey::LOSS, QPointF(time, info.lost));
+    };
+
+    handlers[qlog::TRANSPORT_PACKET_LOST] = on_packet_lost;
+    handlers[qlog::RECOVERY_PACKET_LOST] = on_packet_lost;
+
+    handlers[qlog::PACKET_SENT] = [&](const qlog::Event&) {
+        ++info.sent;
+    };
+
+    // lines are parsed in parallel, the cumulated values above are then
+    // computed on this thread in time order
+    const auto events = read_qlog(path, QlogDialect::NDJSON);
+    if(stop.stop_requested()) return false;
+
+    info.rtt = rtt_stats(events, true);
+
+    // at most one point per metrics update in the line series
+    auto metrics = std::count(events.name.begin(), events.name.end(), qlog::METRICS_UPDATED);
+    for(auto key : { StatKey::CWND, StatKey::BYTES_IN_FLIGHT, StatKey::DISTRIBUTION, StatKey::RTT }) staged.reserve(key, metrics);
+
+    std::vector<size_t> order(events.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    if(!std::is_sorted(events.time.begin(), events.time.end())) {
+        std::stable_sort(order.begin(), order.end(), [&events](size_t a, size_t b) { return events.time[a] < events.time[b]; });
     }
 
+    for(size_t i : order) {
+        qlog::dispatch(handlers, events.at(i));
+    }
+
+    return true;
+}
+
+DisplayBase::Attach QlogDisplay::parse_exp(const fs::path& p, const ExperimentCatalog* catalog, std::stop_token stop)
+{
+    fs::path path = find_qlog(catalog, p);
+
     if(path.empty()) {
         std::cout << "No qlog file found" << std::endl;
-        return;
+        return {};
     }
 
-    create_serie(p, StatKey::BYTES_IN_FLIGHT);
-    create_serie(p, StatKey::CWND);
-    create_serie(p, StatKey::RTT);
-    create_serie(p, StatKey::LOSS);
-    create_serie(p, StatKey::DISTRIBUTION);
-
-    auto impl = path.parent_path().filename().string();
+    Staged staged;
+    Info info{};
+    bool parsed = false;
 
-    if(path.filename().string().starts_with("mvfst") || impl.starts_with("mvfst")) {
+    switch(dialect_of(path)) {
+    case QlogDialect::MVFST:
         std::cout << "Parsing mvfst file : " << path << std::endl;
-        parse_mvfst(path);
-    }
-    else if(path.filename().string().starts_with("quicgo") || impl.starts_with("quicgo")) {
-        std::cout << "Parsing quicgo file : " << path << std::endl;
-        parse_quicgo(path);
-    }
-    else if(path.filename().string().starts_with("quiche") || impl.starts_with("quiche")) {
-        std::cout << "Parsing quiche file : " << path << std::endl;
-        parse_quicgo(path);
-    }
-    else if(path.filename().string().starts_with("msquic") || impl.starts_with("msquic")) {
-        std::cout << "Parsing msquic file : " << path << std::endl;
-        parse_quicgo(path);
+        if(!parse_mvfst(path, staged, info, stop)) return {};
+        parsed = true;
+        break;
+    case QlogDialect::NDJSON:
+        std::cout << "Parsing NDJSON qlog file : " << path << std::endl;
+        if(!parse_quicgo(path, staged, info, stop)) return {};
+        parsed = true;
+        break;
+    case QlogDialect::UNKNOWN:
+        break;
     }
 
-    auto& map = _path_keys[p.c_str()];
+    staged.index();
 
-    for(auto it : map.keys()) {
-        auto info = std::get<StatsKeyProperty::INFO>(map[it]);
-        info.stream = false;
-        std::get<StatsKeyProperty::INFO>(map[it]) = info;
-    }
+    return [this, p, path, staged = std::move(staged), info, parsed]() {
+        auto exp = experiment(p);
 
-    add_serie(p.c_str(), StatKey::BYTES_IN_FLIGHT);
-    add_serie(p.c_str(), StatKey::CWND);
-    add_serie(p.c_str(), StatKey::RTT);
-    add_serie(p.c_str(), StatKey::LOSS);
+        create_serie(exp, StatKey::BYTES_IN_FLIGHT);
+        create_serie(exp, StatKey::CWND);
+        create_serie(exp, StatKey::RTT);
+        create_serie(exp, StatKey::LOSS);
+        create_serie(exp, StatKey::DISTRIBUTION);
 
-    _chart_bitrate->createDefaultAxes();
-    _chart_rtt->createDefaultAxes();
+        attach_points(exp, staged);
 
-    // auto& map = _path_keys[p.c_str()];
-    /*auto* serie = std::get<StatsKeyProperty::SERIE>(map[StatKey::LOSS]);
+        if(parsed) {
+            add_info(path, info);
+            emit on_loss_stats(path.parent_path(), info.lost, info.sent);
+        }
 
-    auto loss_axis = new QValueAxis();
-    _chart_bitrate->addAxis(loss_axis, Qt::AlignRight);
+        for(auto& slot : exp->slots()) slot.info.stream = false;
 
-    const auto& points = serie->points();
-    if(!points.empty()) {
-        const auto& point = points.back();
-        loss_axis->setRange(0,  point.y());
-    }
+        add_serie(exp, StatKey::BYTES_IN_FLIGHT);
+        add_serie(exp, StatKey::CWND);
+        add_serie(exp, StatKey::RTT);
+        add_serie(exp, StatKey::LOSS);
+
+        /*auto* serie = (*exp)[StatKey::LOSS].serie;
 
-    auto axis = serie->attachedAxes();
-    serie->detachAxis(axis.back());
-    serie->attachAxis(loss_axis);*/
+        auto loss_axis = new QValueAxis();
+        _chart_bitrate->addAxis(loss_axis, Qt::AlignRight);
+
+        const auto& points = serie->points();
+        if(!points.empty()) {
+            const auto& point = points.back();
+            loss_axis->setRange(0,  point.y());
+        }
+
+        auto axis = serie->attachedAxes();
+        serie->detachAxis(axis.back());
+        serie->attachAxis(loss_axis);*/
+    };
 }
 
 void QlogDisplay::load_average(const fs::path& p)
 {
-    fs::path file = p / "qlog.csv";
+    fs::path file = find_input(p / "qlog.csv");
 
     if(!fs::exists(file)) return; // in case of udp
 
     using QlogReader = CsvReaderTypeRepeat<',', double, 4>;
 
-    create_serie(p, StatKey::RTT);
+    auto exp = experiment(p);
 
-    Info info;
+    create_serie(exp, StatKey::RTT);
 
-    int sum = 0;
+    Info info;
+    Staged staged;
 
-    for(const auto& it : QlogReader(file)) {
-        const auto& [ts, rtt, loss, sent] = it;
+    const auto [ts, rtt, loss, sent] = QlogReader(file).read_columns();
+    staged.reserve(StatKey::RTT, ts.size());
 
-        QPointF point{ts, rtt / 1000.};
+    for(size_t i = 0; i < ts.size(); ++i) {
+        QPointF point{ts[i], rtt[i] / 1000.};
 
-        add_point(p.c_str(), StatKey::RTT, point);
+        staged.add_point(StatKey::RTT, point);
 
-        info.mean_rtt += rtt;
-        info.variance_rtt += (rtt * rtt);
+        info.rtt.add(rtt[i]);
 
-        info.lost = loss;
-        info.sent = sent;
-        ++sum;
+        info.lost = loss[i];
+        info.sent = sent[i];
     }
 
-    info.mean_rtt /= sum;
-    info.variance_rtt = (info.variance_rtt / sum) - (info.mean_rtt * info.mean_rtt);
+    info.rtt.summarize();
 
     add_info(p, info);
 
-    add_serie(p.c_str(), StatKey::RTT);
+    attach_points(exp, staged);
+    add_serie(exp, StatKey::RTT);
 
     _chart_bitrate->createDefaultAxes();
     _chart_rtt->createDefaultAxes();
@@ -444,112 +533,108 @@ void QlogDisplay::load_average(const fs::path& p)
 }
 
 template<typename T>
-bool QlogDisplay::get_stats(const fs::path& p, std::ifstream& ifs, std::vector<StatLinePoint<T>>& tab, StatKey key)
+bool QlogDisplay::get_stats(Staged& staged, std::istream& ifs, std::vector<StatLinePoint>& tab, StatKey key)
 {
-    tab.emplace_back(StatLinePoint<T>{});
-    if(!get_csv_line(ifs, tab)) {
+    tab.emplace_back(StatLinePoint{});
+    if(!get_csv_line<T>(ifs, tab)) {
         tab.pop_back();
         return false;
     }
 
-    // if(tab.back().values.size() < 4) return true;
-    const auto& map = _path_keys[p.c_str()];
-    const auto& info = std::get<StatsKeyProperty::INFO>(map[key]);
+    // if(tab.back().stats.count < 4) return true;
 
-    if((key == StatKey::CWND || key == StatKey::BYTES_IN_FLIGHT)) {
-        for(int i = 0; i < tab.back().values.size(); ++i) tab.back().values[i] /= 1000.;
-    }
+    if((key == StatKey::CWND || key == StatKey::BYTES_IN_FLIGHT)) tab.back().stats.scale(1 / 1000.);
 
-    if(tab.back().values.size() < 4) {
+    if(tab.back().stats.count < 4) {
         auto time = tab.back().time;
         tab.pop_back();
 
-        if(tab.size() > 0) {
-            tab.push_back(tab.back());
-            tab.back().time = time;
-        }
-    }
-
-    QPointF avg{(double)tab.back().time, get_average(tab.back().values)};
+        if(tab.empty()) return true;
 
-    StatKey key_box, key_inter;
-    switch(key) {
-    case StatKey::CWND:
-        key_box = StatKey::CWND_BOX;
-        key_inter = StatKey::CWND_INTERQUARTILE;
-        break;
-    case StatKey::BYTES_IN_FLIGHT:
-        key_box = StatKey::BYTES_IN_FLIGHT_BOX;
-        key_inter = StatKey::BYTES_IN_FLIGHT_INTERQUARTILE;
-        break;
-    case StatKey::RTT:
-        key_box = StatKey::RTT_BOX;
-        key_inter = StatKey::RTT_INTERQUARTILE;
-        break;
-    default:
-        return false;
+        tab.push_back(tab.back());
+        tab.back().time = time;
     }
 
-    QPointF inter{(double)tab.back().time, get_interquartile_average(tab.back().values)};
-    add_point(p.c_str(), key_inter, inter);
-    add_point(p.c_str(), key, avg);
-    add_point(p.c_str(), key_box, QString::number(tab.back().time), tab.back().values);
+    QPointF avg{(double)tab.back().time, tab.back().stats.mean};
+    staged.add_point(key, avg);
 
     return true;
 }
 
-void QlogDisplay::load_stats_line(const fs::path& p)
+DisplayBase::Attach QlogDisplay::parse_stats_line(const fs::path& p, std::stop_token stop)
 {
-    fs::path file = p / "stats_line_qlog.csv";
-
-    std::ifstream ifs(file.c_str());
-    if(!ifs.is_open()) return; // in case of datagrams
+    fs::path file = find_input(p / "stats_line_qlog.csv");
 
-    create_serie(p, StatKey::CWND);
-    create_serie(p, StatKey::BYTES_IN_FLIGHT);
-    create_serie(p, StatKey::RTT);
+    InputStream ifs(file);
+    if(!ifs.is_open()) return {}; // in case of datagrams
 
-    create_serie(p, StatKey::CWND_INTERQUARTILE);
-    create_serie(p, StatKey::RTT_INTERQUARTILE);
-    create_serie(p, StatKey::BYTES_IN_FLIGHT_INTERQUARTILE);
+    Staged staged;
 
-    create_serie<QBoxPlotSeries>(p, StatKey::CWND_BOX);
-    create_serie<QBoxPlotSeries>(p, StatKey::BYTES_IN_FLIGHT_BOX);
-    create_serie<QBoxPlotSeries>(p, StatKey::RTT_BOX);
-
-    std::vector<StatLinePoint<double>> cwnd;
-    std::vector<StatLinePoint<double>> bif;
-    std::vector<StatLinePoint<double>> rtt;
+    std::vector<StatLinePoint> cwnd;
+    std::vector<StatLinePoint> bif;
+    std::vector<StatLinePoint> rtt;
 
     while(!ifs.eof()) {
-        if(!get_stats(p, ifs, cwnd, StatKey::CWND)) break;
-        get_stats(p, ifs, bif, StatKey::BYTES_IN_FLIGHT);
-        get_stats(p, ifs, rtt, StatKey::RTT);
+        if(stop.stop_requested()) return {};
+
+        if(!get_stats<double>(staged, ifs, cwnd, StatKey::CWND)) break;
+        get_stats<double>(staged, ifs, bif, StatKey::BYTES_IN_FLIGHT);
+        get_stats<double>(staged, ifs, rtt, StatKey::RTT);
     }
 
-    add_serie(p.c_str(), StatKey::CWND);
-    add_serie(p.c_str(), StatKey::BYTES_IN_FLIGHT);
-    add_serie(p.c_str(), StatKey::RTT);
+    staged.index();
 
-    add_serie<QBoxPlotSeries>(p.c_str(), StatKey::CWND_INTERQUARTILE);
-    add_serie<QBoxPlotSeries>(p.c_str(), StatKey::BYTES_IN_FLIGHT_INTERQUARTILE);
-    add_serie<QBoxPlotSeries>(p.c_str(), StatKey::RTT_INTERQUARTILE);
+    // the interquartile means and boxes are only computed when shown
+    return [this, p, staged = std::move(staged), cwnd = share_rows(std::move(cwnd)),
+            bif = share_rows(std::move(bif)), rtt = share_rows(std::move(rtt))]() {
+        auto exp = experiment(p);
 
-    // add_serie<QBoxPlotSeries>(p.c_str(), StatKey::CWND_BOX);
-    // add_serie<QBoxPlotSeries>(p.c_str(), StatKey::BYTES_IN_FLIGHT_BOX);
-    // add_serie<QBoxPlotSeries>(p.c_str(), StatKey::RTT_BOX);
+        create_serie(exp, StatKey::CWND);
+        create_serie(exp, StatKey::BYTES_IN_FLIGHT);
+        create_serie(exp, StatKey::RTT);
 
-    _chart_bitrate->createDefaultAxes();
-    _chart_rtt->createDefaultAxes();
+        attach_points(exp, staged);
+
+        add_serie(exp, StatKey::CWND);
+        add_serie(exp, StatKey::BYTES_IN_FLIGHT);
+        add_serie(exp, StatKey::RTT);
+
+        defer_stat_line(exp, cwnd, StatKey::CWND_INTERQUARTILE, StatKey::CWND_BOX);
+        defer_stat_line(exp, bif, StatKey::BYTES_IN_FLIGHT_INTERQUARTILE, StatKey::BYTES_IN_FLIGHT_BOX);
+        defer_stat_line(exp, rtt, StatKey::RTT_INTERQUARTILE, StatKey::RTT_BOX);
+    };
 }
 
-void QlogDisplay::load(const fs::path& p)
+void QlogDisplay::warm_cache(const fs::path& p)
+{
+    fs::path path = find_qlog(nullptr, p);
+    if(path.empty()) return;
+
+    auto dialect = dialect_of(path);
+    if(dialect != QlogDialect::UNKNOWN) read_qlog(path, dialect);
+}
+
+DisplayBase::Attach QlogDisplay::parse(const fs::path& p, const ExperimentCatalog* catalog, std::stop_token stop)
 {
-    if(p.filename().string() == "average") load_stats_line(p); // load_average(p);
-    else load_exp(p);
+    if(stop.stop_requested()) return {};
+
+    Attach attach;
+    if(p.filename().string() == "average") attach = parse_stats_line(p, stop); // load_average(p);
+    else attach = parse_exp(p, catalog, stop);
+
+    if(!attach) return {};
+
+    return [this, p, attach = std::move(attach)]() {
+        attach();
+        set_makeup(p);
+        update_charts();
+        // _chart_view_rtt->hide();
+    };
+}
 
-    set_makeup(p);
-    // _chart_view_rtt->hide();
+void QlogDisplay::load(const fs::path& p)
+{
+    if(auto attach = parse(p, _catalog.get())) attach();
 }
 
 void QlogDisplay::save(const fs::path& dir)
@@ -563,11 +648,13 @@ void QlogDisplay::save(const fs::path& dir)
 
 void QlogDisplay::add_to_all(const fs::path& dir, AllBitrateDisplay* all)
 {
-    auto& map = _path_keys[dir.c_str()];
-    // all->add_stats(dir, AllBitrateDisplay::CWND, map[CWND]);
-    // all->add_stats(dir, AllBitrateDisplay::BYTES_IN_FLIGHT, map[BYTES_IN_FLIGHT]);
-    // all->add_stats(dir, AllBitrateDisplay::QUIC_RTT, map[RTT]);
-    // all->add_stats(dir, AllBitrateDisplay::QUIC_LOSS, map[LOSS]);
+    auto exp = find_experiment(dir);
+    if(!exp) return;
+
+    // all->add_stats(dir, AllBitrateDisplay::CWND, (*exp)[CWND]);
+    // all->add_stats(dir, AllBitrateDisplay::BYTES_IN_FLIGHT, (*exp)[BYTES_IN_FLIGHT]);
+    // all->add_stats(dir, AllBitrateDisplay::QUIC_RTT, (*exp)[RTT]);
+    // all->add_stats(dir, AllBitrateDisplay::QUIC_LOSS, (*exp)[LOSS]);
 }
 
 void QlogDisplay::set_geometry(float ratio_w, float ratio_h)
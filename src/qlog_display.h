@@ -11,6 +11,7 @@
 #include <QWidget>
 
 #include "display_base.h"
+#include "percentiles.h"
 
 #include <filesystem>
 
@@ -57,37 +58,47 @@ class QlogDisplay : public QObject, public DisplayBase
         NUM_KEYS
     };
 
+    static_assert(StatKey::NUM_KEYS <= MAX_KEYS);
+
     struct Info {
         int lost = 0;
         int sent = 0;
 
-        double mean_rtt = 0;
-        double variance_rtt = 0;
+        SampledStats rtt;
     };
 
     StatsLineChart * _chart_bitrate, * _chart_rtt;
     StatsLineChartView* _chart_view_bitrate, * _chart_view_rtt;
 
-    void init_map(StatMap& map, bool signal) override;
+    void init_map(Experiment& exp) override;
+    void refresh_charts() override;
 
     void add_info(const fs::path& path, const Info& info);
-    void parse_mvfst(const fs::path& path);
-    void parse_quicgo(const fs::path& path);
+
+    // false if stop was requested
+    static bool parse_mvfst(const fs::path& path, Staged& staged, Info& info, std::stop_token stop);
+    static bool parse_quicgo(const fs::path& path, Staged& staged, Info& info, std::stop_token stop);
 
     void load_average(const fs::path& path);
-    void load_exp(const fs::path& path);
-    void load_stats_line(const fs::path& path);
+    Attach parse_exp(const fs::path& path, const ExperimentCatalog* catalog, std::stop_token stop);
+    Attach parse_stats_line(const fs::path& path, std::stop_token stop);
 
     template<typename T>
-    bool get_stats(const fs::path& p, std::ifstream& ifs, std::vector<StatLinePoint<T>>& tab, StatKey key);
+    static bool get_stats(Staged& staged, std::istream& ifs, std::vector<StatLinePoint>& tab, StatKey key);
 
-    void set_makeup(const fs::path& p);
+    void set_makeup(const fs::path& p) override;
 
 public:
     QlogDisplay(QWidget* tab, QVBoxLayout* layout, QListWidget* legend, QTreeWidget* info_widget);
     ~QlogDisplay() = default;
 
     void load(const fs::path& path) override;
+    Attach parse(const fs::path& path, const ExperimentCatalog* catalog, std::stop_token stop = {}) override;
+
+    // Parse the result files of experiment p into their column cache,
+    // without touching any widget. Safe to call from any thread.
+    static void warm_cache(const fs::path& p);
+
     void save(const fs::path& dir) override;
 
     void add_to_all(const fs::path& dir, AllBitrateDisplay* all);
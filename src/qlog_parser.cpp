@@ -0,0 +1,542 @@
+#include "qlog_parser.h"
+
+#include <algorithm>
+#include <charconv>
+#include <optional>
+
+#include <nlohmann/json.hpp>
+
+#include "input_file.h"
+
+using json = nlohmann::json;
+
+namespace qlog
+{
+
+EventMask handled_events(const HandlerTable& handlers)
+{
+    EventMask mask = 0;
+
+    for(size_t i = 0; i < NUM_EVENTS; ++i) {
+        if(handlers[i]) mask |= (1u << i);
+    }
+
+    return mask;
+}
+
+namespace
+{
+
+// SAX handler following traces[].events[] and keeping the fields of the
+// current event only
+class MvfstHandler : public nlohmann::json_sax<json>
+{
+    enum class Key
+    {
+        OTHER,
+        EVENTS,
+        TIME,
+        NAME,
+        DATA
+    };
+
+    const HandlerTable& _handlers;
+    EventMask _wanted;
+    Event _event;
+    bool _skip = false;  // name seen and not handled
+    bool _timed = false; // time seen
+
+    // of the first event with a time, handled or not
+    std::optional<double> _first_time;
+
+    int _depth = 0;
+    int _events_depth = -1;  // depth of the events array
+    int _event_depth = -1;   // depth of the current event object
+    bool _in_data = false;
+
+    Key _key = Key::OTHER;
+    Field _field = NUM_FIELDS;
+
+    bool in_event() const { return _event_depth != -1; }
+
+    void value(double v) {
+        if(!in_event()) return;
+
+        if(_depth == _event_depth && _key == Key::TIME) {
+            _event.time = v;
+            _timed = true;
+        }
+        else if(!_skip && _in_data && _depth == _event_depth + 1 && _field != NUM_FIELDS) _event.set(_field, v);
+    }
+
+    void open() {
+        ++_depth;
+        _key = Key::OTHER;
+        _field = NUM_FIELDS;
+    }
+
+public:
+    explicit MvfstHandler(const HandlerTable& handlers) : _handlers(handlers), _wanted(handled_events(handlers)) {}
+
+    const std::optional<double>& first_time() const { return _first_time; }
+
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t v) override { value(static_cast<double>(v)); return true; }
+    bool number_unsigned(number_unsigned_t v) override { value(static_cast<double>(v)); return true; }
+    bool number_float(number_float_t v, const string_t&) override { value(v); return true; }
+    bool binary(binary_t&) override { return true; }
+
+    bool string(string_t& v) override {
+        if(in_event() && _depth == _event_depth && _key == Key::NAME) {
+            _event.name = event_of(v);
+            _skip = !contains(_wanted, _event.name);
+        }
+
+        return true;
+    }
+
+    bool start_object(std::size_t) override {
+        bool data = (in_event() && _depth == _event_depth && _key == Key::DATA);
+        bool event = (!in_event() && _depth == _events_depth);
+
+        open();
+
+        if(event) {
+            _event.clear();
+            _skip = false;
+            _timed = false;
+            _event_depth = _depth;
+        }
+        else if(data) {
+            _in_data = true;
+        }
+
+        return true;
+    }
+
+    bool end_object() override {
+        if(_depth == _event_depth) {
+            if(_timed && !_first_time) _first_time = _event.time;
+            if(!_skip) dispatch(_handlers, _event);
+            _event_depth = -1;
+        }
+        else if(_in_data && _depth == _event_depth + 1) {
+            _in_data = false;
+        }
+
+        --_depth;
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        bool events = (!in_event() && _key == Key::EVENTS);
+
+        open();
+        if(events) _events_depth = _depth;
+
+        return true;
+    }
+
+    bool end_array() override {
+        if(_depth == _events_depth) _events_depth = -1;
+
+        --_depth;
+        return true;
+    }
+
+    bool key(string_t& k) override {
+        _key = Key::OTHER;
+        _field = NUM_FIELDS;
+
+        if(!in_event()) {
+            if(k == "events") _key = Key::EVENTS;
+        }
+        else if(_depth == _event_depth) {
+            if(k == "time") _key = Key::TIME;
+            else if(k == "name") _key = Key::NAME;
+            else if(k == "data") _key = Key::DATA;
+        }
+        else if(!_skip && _in_data && _depth == _event_depth + 1) {
+            _field = field_of(k);
+        }
+
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override {
+        return false;
+    }
+};
+
+}
+
+bool parse_mvfst(std::istream& is, const HandlerTable& handlers, std::optional<double>* first_time)
+{
+    MvfstHandler handler(handlers);
+    bool ok = json::sax_parse(is, &handler);
+
+    if(first_time) *first_time = handler.first_time();
+    return ok;
+}
+
+bool parse_mvfst(std::istream& is, EventMask wanted, EventColumns& columns)
+{
+    HandlerTable handlers{};
+
+    for(size_t i = 0; i < NUM_EVENTS; ++i) {
+        if(contains(wanted, static_cast<EventName>(i))) {
+            handlers[i] = [&columns](const Event& event) { columns.push(event); };
+        }
+    }
+
+    std::optional<double> first_time;
+    bool ok = parse_mvfst(is, handlers, &first_time);
+
+    if(first_time) columns.first_time = { *first_time };
+    return ok;
+}
+
+namespace
+{
+
+enum class ScanResult
+{
+    OK,
+    MISSING,     // well formed but no name or time
+    SKIPPED,     // event not wanted
+    UNSUPPORTED  // let the json parser handle it
+};
+
+// Minimal in place json reader, enough to walk the keys of a qlog event
+class LineScanner
+{
+    const char* _p;
+    const char* _end;
+
+public:
+    explicit LineScanner(std::string_view s) : _p(s.data()), _end(s.data() + s.size()) {}
+
+    void ws() {
+        while(_p != _end && (*_p == ' ' || *_p == '\t' || *_p == '\r' || *_p == '\n')) ++_p;
+    }
+
+    char peek() {
+        ws();
+        return _p == _end ? '\0' : *_p;
+    }
+
+    bool consume(char c) {
+        if(peek() != c) return false;
+
+        ++_p;
+        return true;
+    }
+
+    // String without escape sequences
+    bool string(std::string_view& out) {
+        if(!consume('"')) return false;
+
+        const char* begin = _p;
+        while(_p != _end && *_p != '"') {
+            if(*_p == '\\') return false;
+            ++_p;
+        }
+
+        if(_p == _end) return false;
+
+        out = std::string_view(begin, _p - begin);
+        ++_p;
+        return true;
+    }
+
+    bool number(double& v) {
+        ws();
+
+        auto [ptr, ec] = std::from_chars(_p, _end, v);
+        if(ec != std::errc{}) return false;
+
+        _p = ptr;
+        return true;
+    }
+
+    bool skip_string() {
+        ++_p; // opening quote
+
+        while(_p != _end && *_p != '"') {
+            if(*_p == '\\' && ++_p == _end) return false;
+            ++_p;
+        }
+
+        if(_p == _end) return false;
+
+        ++_p;
+        return true;
+    }
+
+    bool skip_value() {
+        char c = peek();
+
+        if(c == '"') return skip_string();
+
+        if(c == '{' || c == '[') {
+            int depth = 0;
+
+            while(_p != _end) {
+                c = *_p;
+
+                if(c == '"') {
+                    if(!skip_string()) return false;
+                    continue;
+                }
+
+                if(c == '{' || c == '[') ++depth;
+                else if(c == '}' || c == ']') --depth;
+
+                ++_p;
+                if(depth == 0) return true;
+            }
+
+            return false;
+        }
+
+        // number or literal
+        const char* begin = _p;
+        while(_p != _end && *_p != ',' && *_p != '}' && *_p != ']' && *_p != ' ') ++_p;
+
+        return _p != begin;
+    }
+
+    // Iterate the members of an object, member(key) must consume the value
+    template<typename F>
+    bool object(F&& member) {
+        if(!consume('{')) return false;
+        if(consume('}')) return true;
+
+        do {
+            std::string_view key;
+            if(!string(key) || !consume(':')) return false;
+            if(!member(key)) return false;
+        } while(consume(','));
+
+        return consume('}');
+    }
+};
+
+ScanResult scan_line(std::string_view text, Event& event, EventMask wanted)
+{
+    LineScanner scanner(text);
+
+    bool has_time = false;
+    bool has_name = false;
+    bool skipped = false;
+
+    bool ok = scanner.object([&](std::string_view key) {
+        if(key == "time") {
+            has_time = scanner.number(event.time);
+            return has_time;
+        }
+
+        if(key == "name") {
+            std::string_view name;
+            has_name = scanner.string(name);
+            if(!has_name) return false;
+
+            // stop before the data of unwanted events
+            event.name = event_of(name);
+            skipped = !contains(wanted, event.name);
+            return !skipped;
+        }
+
+        if(key == "data" && scanner.peek() == '{') {
+            return scanner.object([&](std::string_view data_key) {
+                Field f = field_of(data_key);
+                if(f == NUM_FIELDS) return scanner.skip_value();
+
+                double v;
+                if(!scanner.number(v)) return false;
+
+                event.set(f, v);
+                return true;
+            });
+        }
+
+        return scanner.skip_value();
+    });
+
+    if(skipped) return ScanResult::SKIPPED;
+    if(!ok) return ScanResult::UNSUPPORTED;
+
+    return (has_time && has_name) ? ScanResult::OK : ScanResult::MISSING;
+}
+
+bool parse_line_dom(std::string_view text, Event& event, EventMask wanted)
+{
+    auto line_json = json::parse(text, nullptr, false);
+    if(line_json.is_discarded() || !line_json.is_object()) return false;
+
+    auto name = line_json.find("name");
+    auto time = line_json.find("time");
+
+    if(name == line_json.end() || !name->is_string() || time == line_json.end() || !time->is_number()) {
+        return false;
+    }
+
+    event.name = event_of(name->get_ref<const std::string&>());
+    if(!contains(wanted, event.name)) return false;
+
+    event.time = time->get<double>();
+
+    auto data = line_json.find("data");
+    if(data == line_json.end() || !data->is_object()) return true;
+
+    for(auto it = data->begin(); it != data->end(); ++it) {
+        Field f = field_of(it.key());
+        if(f != NUM_FIELDS && it.value().is_number()) event.set(f, it.value().get<double>());
+    }
+
+    return true;
+}
+
+}
+
+bool parse_ndjson_line(std::string_view line, Event& event, EventMask wanted)
+{
+    auto pos = line.find('{');
+    if(pos == std::string_view::npos) return false;
+
+    line.remove_prefix(pos);
+    event.clear();
+
+    switch(scan_line(line, event, wanted)) {
+    case ScanResult::OK:
+        return true;
+    case ScanResult::MISSING:
+    case ScanResult::SKIPPED:
+        return false;
+    case ScanResult::UNSUPPORTED:
+        break;
+    }
+
+    event.clear();
+    return parse_line_dom(line, event, wanted);
+}
+
+std::string columns_schema(EventMask wanted)
+{
+    // bumped when EventColumns itself changes
+    constexpr int VERSION = 2;
+
+    std::string schema = "v" + std::to_string(VERSION) + " events:";
+    for(auto name : EVENT_NAMES.keys()) (schema += name) += ',';
+
+    schema += " fields:";
+    for(auto field : FIELD_KEYS.keys()) (schema += field) += ',';
+
+    schema += " wanted:" + std::to_string(wanted);
+    schema += " sizes:" + std::to_string(sizeof(EventName)) + ',' + std::to_string(sizeof(double));
+
+    return schema;
+}
+
+double EventColumns::origin() const
+{
+    if(!first_time.empty()) return first_time.front();
+    return time.empty() ? 0. : time.front();
+}
+
+Event EventColumns::at(size_t i) const
+{
+    Event event;
+    event.name = name[i];
+    event.time = time[i];
+    event.present = present[i];
+
+    for(size_t f = 0; f < NUM_FIELDS; ++f) event.data[f] = data[f][i];
+
+    return event;
+}
+
+void EventColumns::push(const Event& event)
+{
+    name.push_back(event.name);
+    time.push_back(event.time);
+    present.push_back(event.present);
+
+    for(size_t f = 0; f < NUM_FIELDS; ++f) data[f].push_back(event.data[f]);
+}
+
+void EventColumns::append(EventColumns&& other)
+{
+    auto append_column = [](auto& column, auto& part) {
+        column.insert(column.end(), part.begin(), part.end());
+        part = {};
+    };
+
+    append_column(name, other.name);
+    append_column(time, other.time);
+    append_column(present, other.present);
+
+    if(first_time.empty()) first_time = std::move(other.first_time);
+    other.first_time = {};
+
+    for(size_t f = 0; f < NUM_FIELDS; ++f) append_column(data[f], other.data[f]);
+}
+
+namespace
+{
+
+void parse_range(std::string_view range, EventMask wanted, EventColumns& columns)
+{
+    Event event;
+
+    while(!range.empty()) {
+        auto eol = range.find('\n');
+        auto line = range.substr(0, eol);
+        range.remove_prefix(eol == std::string_view::npos ? range.size() : eol + 1);
+
+        if(parse_ndjson_line(line, event, wanted)) columns.push(event);
+    }
+}
+
+}
+
+EventColumns parse_ndjson(const fs::path& p, EventMask wanted, ThreadPool& pool)
+{
+    static constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+
+    EventColumns columns;
+
+    if(compression_of(p) != Compression::NONE) {
+        LineSource source(p);
+        for(auto window = source.next(); !window.empty(); window = source.next()) {
+            parse_range(window, wanted, columns);
+        }
+
+        return columns;
+    }
+
+    MappedFile file(p);
+
+    size_t chunks = std::clamp<size_t>(file.size() / MIN_CHUNK_SIZE, 1, pool.size() * 4);
+    auto ranges = split_lines(file.view(), chunks);
+
+    std::vector<EventColumns> batches(ranges.size());
+    std::vector<std::future<void>> pending;
+    pending.reserve(ranges.size());
+
+    for(size_t i = 0; i < ranges.size(); ++i) {
+        pending.push_back(pool.submit([&ranges, &batches, wanted, i]() {
+            parse_range(ranges[i], wanted, batches[i]);
+        }));
+    }
+
+    pool.wait(pending);
+    for(auto& f : pending) f.get();
+
+    for(auto& batch : batches) columns.append(std::move(batch));
+
+    return columns;
+}
+
+}
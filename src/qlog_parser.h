@@ -0,0 +1,241 @@
+#ifndef QLOG_PARSER_H
+#define QLOG_PARSER_H
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <filesystem>
+
+#include "thread_pool.h"
+
+namespace fs = std::filesystem;
+
+namespace qlog
+{
+
+// Compile time perfect hash of a fixed set of keys. The seed is searched
+// at compile time so that every key lands in its own slot, a lookup is then
+// one hash and one string compare.
+template<size_t N>
+class PerfectHash
+{
+    static constexpr size_t TABLE_SIZE = std::bit_ceil(N * 2);
+    static constexpr uint8_t EMPTY = 0xff;
+
+    static_assert(N < EMPTY);
+
+    std::array<std::string_view, N> _keys;
+    std::array<uint8_t, TABLE_SIZE> _slots{};
+    uint32_t _seed = 0;
+
+    static constexpr uint32_t hash(std::string_view s, uint32_t seed) {
+        // FNV-1a
+        uint32_t h = 2166136261u ^ seed;
+        for(char c : s) {
+            h ^= static_cast<uint8_t>(c);
+            h *= 16777619u;
+        }
+
+        return h;
+    }
+
+    static constexpr size_t slot(std::string_view s, uint32_t seed) {
+        return hash(s, seed) & (TABLE_SIZE - 1);
+    }
+
+public:
+    consteval explicit PerfectHash(const std::array<std::string_view, N>& keys) : _keys(keys) {
+        for(;; ++_seed) {
+            _slots.fill(EMPTY);
+
+            bool collision = false;
+            for(size_t i = 0; i < N && !collision; ++i) {
+                auto& s = _slots[slot(_keys[i], _seed)];
+
+                collision = (s != EMPTY);
+                s = static_cast<uint8_t>(i);
+            }
+
+            if(!collision) return;
+        }
+    }
+
+    // in the order of their index
+    constexpr const std::array<std::string_view, N>& keys() const { return _keys; }
+
+    // Index of key, N when not in the set
+    constexpr size_t find(std::string_view key) const {
+        uint8_t i = _slots[slot(key, _seed)];
+        return (i != EMPTY && _keys[i] == key) ? i : N;
+    }
+};
+
+// data fields charted by QlogDisplay, everything else is skipped
+enum Field : uint8_t
+{
+    CONGESTION_WINDOW,
+    BYTES_IN_FLIGHT,
+    LATEST_RTT,
+    SMOOTHED_RTT,
+    LOST_PACKETS,
+    TOTAL_SEND_PACKETS,
+    NUM_FIELDS
+};
+
+inline constexpr PerfectHash<NUM_FIELDS> FIELD_KEYS({
+    "congestion_window",
+    "bytes_in_flight",
+    "latest_rtt",
+    "smoothed_rtt",
+    "lost_packets",
+    "total_send_packets"
+});
+
+// Field of a key of the event data object, NUM_FIELDS if not charted
+constexpr Field field_of(std::string_view key)
+{
+    return static_cast<Field>(FIELD_KEYS.find(key));
+}
+
+// events handled by at least one qlog dialect
+enum EventName : uint8_t
+{
+    METRICS_UPDATED,        // recovery:metrics_updated
+    LOSS_PACKETS_LOST,      // loss:packets_lost (mvfst)
+    PACKET_SENT,            // transport:packet_sent
+    TRANSPORT_PACKET_LOST,  // transport:packet_lost
+    RECOVERY_PACKET_LOST,   // recovery:packet_lost
+    NUM_EVENTS,
+    UNKNOWN_EVENT = NUM_EVENTS
+};
+
+inline constexpr PerfectHash<NUM_EVENTS> EVENT_NAMES({
+    "recovery:metrics_updated",
+    "loss:packets_lost",
+    "transport:packet_sent",
+    "transport:packet_lost",
+    "recovery:packet_lost"
+});
+
+constexpr EventName event_of(std::string_view name)
+{
+    return static_cast<EventName>(EVENT_NAMES.find(name));
+}
+
+static_assert(event_of("transport:packet_sent") == PACKET_SENT);
+static_assert(event_of("transport:packet_received") == UNKNOWN_EVENT);
+static_assert(field_of("smoothed_rtt") == SMOOTHED_RTT);
+
+// Set of events, one bit per EventName
+using EventMask = uint32_t;
+
+inline constexpr EventMask ALL_EVENTS = (1u << NUM_EVENTS) - 1;
+
+constexpr bool contains(EventMask mask, EventName name)
+{
+    return name != UNKNOWN_EVENT && (mask & (1u << name));
+}
+
+struct Event
+{
+    double time = 0.;
+    EventName name = UNKNOWN_EVENT;
+
+    std::array<double, NUM_FIELDS> data{};
+    uint32_t present = 0;
+
+    bool has(Field f) const { return present & (1u << f); }
+    double get(Field f) const { return data[f]; }
+
+    void set(Field f, double v) {
+        data[f] = v;
+        present |= (1u << f);
+    }
+
+    void clear() {
+        time = 0.;
+        name = UNKNOWN_EVENT;
+        present = 0;
+    }
+};
+
+// Per dialect handlers indexed by event name, events without handler are
+// skipped
+using Handler = std::function<void(const Event&)>;
+using HandlerTable = std::array<Handler, NUM_EVENTS>;
+
+EventMask handled_events(const HandlerTable& handlers);
+
+inline void dispatch(const HandlerTable& handlers, const Event& event)
+{
+    if(event.name != UNKNOWN_EVENT && handlers[event.name]) handlers[event.name](event);
+}
+
+// Fill event from one line of a NDJSON qlog (quic-go, quiche, msquic).
+// The line is scanned in place and only the charted keys are converted,
+// lines the scanner does not handle (escaped strings, non numeric
+// fields...) fall back to a full json parse. Returns false when the line
+// holds no event with a name and a time, or when the event is not in
+// wanted, in which case the scan stops at the name.
+bool parse_ndjson_line(std::string_view line, Event& event, EventMask wanted = ALL_EVENTS);
+
+// Events of a qlog in column form
+struct EventColumns
+{
+    std::vector<EventName> name;
+    std::vector<double> time;
+    std::vector<uint32_t> present;
+    std::array<std::vector<double>, NUM_FIELDS> data;
+
+    // time of the first event of the trace, kept or not. None when the
+    // parser does not record it.
+    std::vector<double> first_time;
+
+    size_t size() const { return time.size(); }
+
+    // first_time, or the time of the first kept event
+    double origin() const;
+    Event at(size_t i) const;
+
+    void push(const Event& event);
+    void append(EventColumns&& other);
+
+    template<typename F>
+    void for_each_column(F&& f) {
+        f(name);
+        f(time);
+        f(present);
+        for(auto& column : data) f(column);
+        f(first_time);
+    }
+};
+
+// Layout of the columns of the wanted events, for their cache. The event
+// and field tables are part of it since their raw indices are stored.
+std::string columns_schema(EventMask wanted);
+
+// Parse the wanted events of a NDJSON qlog into columns, in file order.
+// Line aligned chunks of the file are parsed on pool, compressed files are
+// read sequentially.
+EventColumns parse_ndjson(const fs::path& p, EventMask wanted, ThreadPool& pool = ThreadPool::global());
+
+// Stream the events of a mvfst qlog (a single json document with
+// traces[].events[]) to their handler, without building the document. Only
+// the event time, name and charted data fields are kept, so memory does
+// not depend on the trace size. Returns false on malformed input, the
+// events before the error have been delivered. first_time receives the
+// time of the first event, handled or not.
+bool parse_mvfst(std::istream& is, const HandlerTable& handlers, std::optional<double>* first_time = nullptr);
+
+// Same, keeping the wanted events in columns
+bool parse_mvfst(std::istream& is, EventMask wanted, EventColumns& columns);
+
+}
+
+#endif // QLOG_PARSER_H
@@ -0,0 +1,121 @@
+#ifndef RATE_WINDOW_H
+#define RATE_WINDOW_H
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Averaging of the packet rates drawn by the displays
+enum class RateWindow : uint8_t
+{
+    MS_50,
+    MS_200,
+    S_1,
+    EWMA,   // exponential decay with the 200 ms time constant
+    NUM
+};
+
+constexpr const char* rate_window_name(RateWindow window)
+{
+    switch(window) {
+    case RateWindow::MS_50: return "50 ms window";
+    case RateWindow::MS_200: return "200 ms window";
+    case RateWindow::S_1: return "1 s window";
+    case RateWindow::EWMA: return "EWMA 200 ms";
+    default: return "";
+    }
+}
+
+constexpr RateWindow next_rate_window(RateWindow window)
+{
+    return static_cast<RateWindow>((static_cast<uint8_t>(window) + 1) % static_cast<uint8_t>(RateWindow::NUM));
+}
+
+// Amount of N channels over a sliding time window, updated packet by packet
+// in one pass. Packets are added in time order. Those of the window are
+// kept in a ring buffer with the running sums, so each one is added and
+// removed once.
+template<size_t N>
+class WindowedRate
+{
+public:
+    using Values = std::array<int64_t, N>;
+    using Amounts = std::array<double, N>;
+
+private:
+    struct Packet
+    {
+        int64_t time;
+        Values values;
+    };
+
+    bool _ewma;
+    int64_t _length;  // µs, the time constant of the EWMA
+
+    std::vector<Packet> _ring = std::vector<Packet>(64);
+    size_t _head = 0;
+    size_t _size = 0;
+
+    Values _sums{};
+    Amounts _decayed{};
+    int64_t _last = -1;
+
+    void push(const Packet& packet)
+    {
+        // capacity stays a power of two
+        if(_size == _ring.size()) {
+            std::vector<Packet> ring(_ring.size() * 2);
+            for(size_t i = 0; i < _size; ++i) ring[i] = _ring[(_head + i) & (_ring.size() - 1)];
+
+            _ring = std::move(ring);
+            _head = 0;
+        }
+
+        _ring[(_head + _size) & (_ring.size() - 1)] = packet;
+        ++_size;
+    }
+
+public:
+    explicit WindowedRate(RateWindow window)
+        : _ewma(window == RateWindow::EWMA)
+    {
+        switch(window) {
+        case RateWindow::MS_50: _length = 50000; break;
+        case RateWindow::S_1: _length = 1000000; break;
+        default: _length = 200000; break;
+        }
+    }
+
+    // Converts an amount of the window to an amount per second
+    double per_second() const { return 1000000. / _length; }
+
+    // Amounts of the window ending at time, the packet included
+    Amounts add(int64_t time, const Values& values)
+    {
+        Amounts amounts;
+
+        if(_ewma) {
+            double decay = (_last >= 0) ? std::exp(-static_cast<double>(time - _last) / _length) : 0.;
+            _last = time;
+
+            for(size_t c = 0; c < N; ++c) amounts[c] = _decayed[c] = _decayed[c] * decay + values[c];
+            return amounts;
+        }
+
+        while(_size > 0 && _ring[_head].time < time - _length) {
+            const auto& front = _ring[_head];
+            for(size_t c = 0; c < N; ++c) _sums[c] -= front.values[c];
+
+            _head = (_head + 1) & (_ring.size() - 1);
+            --_size;
+        }
+
+        push({ time, values });
+        for(size_t c = 0; c < N; ++c) amounts[c] = (_sums[c] += values[c]);
+
+        return amounts;
+    }
+};
+
+#endif // RATE_WINDOW_H
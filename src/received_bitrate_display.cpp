@@ -8,8 +8,11 @@
 #include <QBoxPlotSeries>
 
 #include "csv_reader.h"
+#include "input_file.h"
+#include "column_cache.h"
 #include "stats_line_chart.h"
 #include "all_bitrate.h"
+#include "percentiles.h"
 
 std::vector<QColor> ReceivedBitrateDisplay::colors = { Qt::blue, Qt::yellow, Qt::darkCyan, Qt::darkRed, Qt::blue,
                                                       Qt::green, Qt::yellow, Qt::darkCyan, Qt::darkRed };
@@ -41,54 +44,29 @@ void ReceivedBitrateDisplay::on_keyboard_event(QKeyEvent* key)
     }
 }
 
-void ReceivedBitrateDisplay::init_map(StatMap& map, bool signal)
+void ReceivedBitrateDisplay::init_map(Experiment& exp)
 {
-    map[StatKey::LINK] = std::make_tuple("link", nullptr, _chart_bitrate, ExpInfo{false, QuicImpl::NONE, CCAlgo::NONE, false, true}, false);
-    map[StatKey::BITRATE] = std::make_tuple("bitrate", nullptr, _chart_bitrate, ExpInfo{}, false);
-    map[StatKey::FPS] = std::make_tuple("fps", nullptr, _chart_fps, ExpInfo{}, false);
-    map[StatKey::FRAME_DROPPED] = std::make_tuple("frame dropped", nullptr, nullptr, ExpInfo{}, false);
-    map[StatKey::FRAME_DECODED] = std::make_tuple("frame decoded", nullptr, nullptr, ExpInfo{}, false);
-    map[StatKey::FRAME_KEY_DECODED] = std::make_tuple("frame key decoded", nullptr, nullptr, ExpInfo{}, false);
-    map[StatKey::FRAME_RENDERED] = std::make_tuple("frame rendered", nullptr, nullptr, ExpInfo{}, false);
-    map[StatKey::QUIC_SENT] = std::make_tuple("quic sent bitrate", nullptr, _chart_bitrate, ExpInfo{}, false);
-
-    map[StatKey::BITRATE_INTERQUARTILE] = std::make_tuple("bitrate interquartile", nullptr, _chart_bitrate, ExpInfo{}, false);
-    map[StatKey::BITRATE_BOX] = std::make_tuple("bitrate box", nullptr, _chart_bitrate, ExpInfo{}, false);
-    map[StatKey::FPS_INTERQUARTILE] = std::make_tuple("fps interquartile", nullptr, _chart_fps, ExpInfo{}, false);
-    map[StatKey::FPS_BOX] = std::make_tuple("fps box", nullptr, _chart_fps, ExpInfo{}, false);
-
-    if(signal) {
-        connect(_legend, &QListWidget::itemChanged, this, [&map](QListWidgetItem* item) -> void {
-            StatKey key = static_cast<StatKey>(item->data(1).toUInt());
-
-            std::get<StatsKeyProperty::SHOW>(map[key]) = item->checkState() == Qt::Checked;
-
-            auto line = std::get<StatsKeyProperty::SERIE>(map[key]);
-            if(line == nullptr) return;
-
-            if(item->checkState() == Qt::Checked) line->show();
-            else line->hide();
-        });
-    }
+    exp.declare(StatKey::LINK, {"link", nullptr, _chart_bitrate, ExpInfo{false, QuicImpl::NONE, CCAlgo::NONE, false, true}, false});
+    exp.declare(StatKey::BITRATE, {"bitrate", nullptr, _chart_bitrate, ExpInfo{}, false});
+    exp.declare(StatKey::FPS, {"fps", nullptr, _chart_fps, ExpInfo{}, false});
+    exp.declare(StatKey::FRAME_DROPPED, {"frame dropped", nullptr, nullptr, ExpInfo{}, false});
+    exp.declare(StatKey::FRAME_DECODED, {"frame decoded", nullptr, nullptr, ExpInfo{}, false});
+    exp.declare(StatKey::FRAME_KEY_DECODED, {"frame key decoded", nullptr, nullptr, ExpInfo{}, false});
+    exp.declare(StatKey::FRAME_RENDERED, {"frame rendered", nullptr, nullptr, ExpInfo{}, false});
+    exp.declare(StatKey::QUIC_SENT, {"quic sent bitrate", nullptr, _chart_bitrate, ExpInfo{}, false});
+
+    exp.declare(StatKey::BITRATE_INTERQUARTILE, {"bitrate interquartile", nullptr, _chart_bitrate, ExpInfo{}, false});
+    exp.declare(StatKey::BITRATE_BOX, {"bitrate box", nullptr, _chart_bitrate, ExpInfo{}, false});
+    exp.declare(StatKey::FPS_INTERQUARTILE, {"fps interquartile", nullptr, _chart_fps, ExpInfo{}, false});
+    exp.declare(StatKey::FPS_BOX, {"fps box", nullptr, _chart_fps, ExpInfo{}, false});
 }
 
 void ReceivedBitrateDisplay::set_makeup(const fs::path& path)
 {
-    const auto& map = _path_keys[path.c_str()];
-
-    QFont font = _chart_bitrate->font();
-    font.setPointSize(40);
-    font.setBold(true);
+    auto exp = find_experiment(path);
+    if(!exp) return;
 
-    _chart_bitrate->legend()->setMarkerShape(QLegend::MarkerShapeFromSeries);
-    _chart_bitrate->legend()->setFont(font);
-    _chart_bitrate->legend()->detachFromChart();
-
-    _chart_fps->legend()->setMarkerShape(QLegend::MarkerShapeFromSeries);
-    _chart_fps->legend()->setFont(font);
-    _chart_fps->legend()->detachFromChart();
-
-    for(const auto& [name, abs_serie, chart, info, show] : map) {
+    for(const auto& [name, abs_serie, chart, info, show] : exp->slots()) {
         auto* serie = dynamic_cast<QLineSeries*>(abs_serie);
         if(!serie) continue;
 
@@ -110,6 +88,24 @@ void ReceivedBitrateDisplay::set_makeup(const fs::path& path)
 
         serie->setPen(pen);
     }
+}
+
+void ReceivedBitrateDisplay::refresh_charts()
+{
+    _chart_bitrate->createDefaultAxes();
+    _chart_fps->createDefaultAxes();
+
+    QFont font = _chart_bitrate->font();
+    font.setPointSize(40);
+    font.setBold(true);
+
+    _chart_bitrate->legend()->setMarkerShape(QLegend::MarkerShapeFromSeries);
+    _chart_bitrate->legend()->setFont(font);
+    _chart_bitrate->legend()->detachFromChart();
+
+    _chart_fps->legend()->setMarkerShape(QLegend::MarkerShapeFromSeries);
+    _chart_fps->legend()->setFont(font);
+    _chart_fps->legend()->detachFromChart();
 
     auto setup_axes = [&font](auto&& axe,const std::string& name) {
         axe->setTitleText(name.c_str());
@@ -135,208 +131,254 @@ void ReceivedBitrateDisplay::set_makeup(const fs::path& path)
     if(!axes.empty()) setup_axes(axes.front(), "FPS");
 }
 
-void ReceivedBitrateDisplay::load_exp(const fs::path& p)
+namespace
+{
+
+using BitrateReader = CsvReaderTypeRepeat<',', int, 8>;
+using QuicSentReader = CsvReaderTypeRepeat<',', double, 2>;
+
+BitrateReader::columns_type read_bitrate_csv(const fs::path& path)
 {
-    fs::path path = p / "bitrate.csv";
+    return column_cache::load<BitrateReader::columns_type>(path, "bitrate:int*8", [&path]() {
+        return BitrateReader(path).read_columns();
+    });
+}
 
-    using BitrateReader = CsvReaderTypeRepeat<',', int, 8>;
-    using QuicSentReader = CsvReaderTypeRepeat<',', double, 2>;
+QuicSentReader::columns_type read_quic_csv(const fs::path& path)
+{
+    return column_cache::load<QuicSentReader::columns_type>(path, "quic:double*2", [&path]() {
+        return QuicSentReader(path).read_columns();
+    });
+}
 
-    if(_path_keys.empty()) create_serie(p, StatKey::LINK);
+}
 
-    create_serie(p, StatKey::BITRATE);
-    create_serie(p, StatKey::FPS);
-    create_serie(p, StatKey::QUIC_SENT);
+void ReceivedBitrateDisplay::warm_cache(const fs::path& p)
+{
+    fs::path bitrate = find_input(p / "bitrate.csv");
+    if(fs::exists(bitrate)) read_bitrate_csv(bitrate);
 
-    auto& map = _path_keys[p.c_str()];
-    auto info = std::get<StatsKeyProperty::INFO>(map[StatKey::QUIC_SENT]);
-    info.color = colors[current_color];
-    std::get<StatsKeyProperty::INFO>(map[StatKey::QUIC_SENT]) = info;
-    info = std::get<StatsKeyProperty::INFO>(map[StatKey::BITRATE]);
-    info.color = colors[current_color];
-    std::get<StatsKeyProperty::INFO>(map[StatKey::BITRATE]) = info;
+    fs::path quic = find_input(p / "quic.csv");
+    if(fs::exists(quic)) read_quic_csv(quic);
+}
 
-    ++current_color;
-    current_color = current_color % colors.size();
+DisplayBase::Attach ReceivedBitrateDisplay::parse_exp(const fs::path& p, std::stop_token stop)
+{
+    fs::path path = find_input(p / "bitrate.csv");
 
-    // std::get<StatsKeyProperty::NAME>(_path_keys[p.c_str()][StatKey::BITRATE]) = p.c_str();
+    Staged staged;
 
-    uint64_t sum = 0;
+    // of this experiment only
+    SampledStats bitrate_stats, quic_stats;
+    RunningStats fps_stats;
 
     /*for(auto &it : BitrateReader(path)) {
         const auto& [time, bitrate, link, fps, frame_dropped, frame_decoded, frame_key_decoded, frame_rendered] = it;
         QPoint p_bitrate(time, bitrate), p_fps(time, fps), p_link(time, link);
-        if(_path_keys.size() == 1)  add_point(p.c_str(), StatKey::LINK, p_link);
+        if(first) add_point(exp, StatKey::LINK, p_link);
     }*/
 
-    for(auto &it : BitrateReader(path)) {
-        const auto& [time, bitrate, link, fps, frame_dropped, frame_decoded, frame_key_decoded, frame_rendered] = it;
+    const auto [time, bitrate, link, fps, frame_dropped, frame_decoded, frame_key_decoded, frame_rendered] = read_bitrate_csv(path);
+    if(stop.stop_requested()) return {};
 
-        QPoint p_bitrate(time, bitrate), p_fps(time, fps), p_link(time, link);
+    for(auto key : { StatKey::LINK, StatKey::BITRATE, StatKey::FPS }) staged.reserve(key, time.size());
 
-        if(_path_keys.size() == 1)  add_point(p.c_str(), StatKey::LINK, p_link);
-        add_point(p.c_str(), StatKey::BITRATE, p_bitrate);
-        add_point(p.c_str(), StatKey::FPS, p_fps);
+    for(size_t i = 0; i < time.size(); ++i) {
+        QPoint p_bitrate(time[i], bitrate[i]), p_fps(time[i], fps[i]), p_link(time[i], link[i]);
 
-        _infos_array[StatKey::BITRATE].mean += bitrate;
-        _infos_array[StatKey::BITRATE].variance += (bitrate * bitrate);
-        _infos_array[StatKey::FPS].mean += fps;
-        _infos_array[StatKey::FPS].variance += (fps * fps);
+        // only attached to the first experiment loaded
+        staged.add_point(StatKey::LINK, p_link);
+        staged.add_point(StatKey::BITRATE, p_bitrate);
+        staged.add_point(StatKey::FPS, p_fps);
 
-        ++sum;
+        bitrate_stats.add(bitrate[i]);
+        fps_stats.add(fps[i]);
     }
 
-    _infos_array[StatKey::BITRATE].mean /= sum;
-    _infos_array[StatKey::BITRATE].variance = (_infos_array[StatKey::BITRATE].variance / sum) - ( _infos_array[StatKey::BITRATE].mean *  _infos_array[StatKey::BITRATE].mean);
-    _infos_array[StatKey::FPS].mean /= sum;
-    _infos_array[StatKey::FPS].variance = (_infos_array[StatKey::FPS].variance / sum) - ( _infos_array[StatKey::FPS].mean *  _infos_array[StatKey::FPS].mean);
+    fs::path quiccsv = find_input(p / "quic.csv");
+    bool has_quic = fs::exists(quiccsv);
 
-    if(_path_keys.size() == 1) add_serie(p.c_str(), StatKey::LINK);
-    add_serie(p.c_str(), StatKey::BITRATE);
-    add_serie(p.c_str(), StatKey::FPS);
+    if(has_quic) {
+        const auto [quic_time, quic_bitrate] = read_quic_csv(quiccsv);
+        if(stop.stop_requested()) return {};
 
-    QTreeWidgetItem * item = new QTreeWidgetItem(_info);
-    item->setText(0, path.parent_path().filename().c_str());
+        staged.reserve(StatKey::QUIC_SENT, quic_time.size());
 
-    QTreeWidgetItem * bitrate_mean = new QTreeWidgetItem(item);
-    bitrate_mean->setText(0, "RTC Bitrate mean");
-    bitrate_mean->setText(1, QString::number(_infos_array[StatKey::BITRATE].mean));
+        for(size_t i = 0; i < quic_time.size(); ++i) {
+            QPointF p_bitrate{quic_time[i], quic_bitrate[i] * 8. / 1000.};
 
-    QTreeWidgetItem * bitrate_variance = new QTreeWidgetItem(item);
-    bitrate_variance->setText(0, "RTC Bitrate variance");
-    bitrate_variance->setText(1, QString::number(_infos_array[StatKey::BITRATE].variance));
+            staged.add_point(StatKey::QUIC_SENT, p_bitrate);
 
-    QTreeWidgetItem * fps_mean = new QTreeWidgetItem(item);
-    fps_mean->setText(0, "FPS mean");
-    fps_mean->setText(1, QString::number(_infos_array[StatKey::FPS].mean));
+            quic_stats.add(p_bitrate.y());
+        }
+    }
 
-    QTreeWidgetItem * fps_variance= new QTreeWidgetItem(item);
-    fps_variance->setText(0, "FPS variance");
-    fps_variance->setText(1, QString::number(_infos_array[StatKey::FPS].variance));
+    bitrate_stats.summarize();
+    quic_stats.summarize();
 
-    fs::path quiccsv = p / "quic.csv";
+    staged.index();
 
-    if(fs::exists(quiccsv)) {
+    return [=, this, staged = std::move(staged)]() {
+        // the link is drawn once, with the first experiment
+        bool first = _experiments.empty();
+        auto exp = experiment(p);
 
-        for(auto& it : QuicSentReader(quiccsv)) {
-            const auto& [time, bitrate ] = it;
-            QPointF p_bitrate{time, bitrate * 8. / 1000.};
+        if(first) create_serie(exp, StatKey::LINK);
 
-            add_point(p.c_str(), StatKey::QUIC_SENT, p_bitrate);
+        create_serie(exp, StatKey::BITRATE);
+        create_serie(exp, StatKey::FPS);
+        create_serie(exp, StatKey::QUIC_SENT);
 
-            _infos_array[StatKey::QUIC_SENT].mean += p_bitrate.y();
-            _infos_array[StatKey::QUIC_SENT].variance += (p_bitrate.y() * p_bitrate.y());
-        }
+        (*exp)[StatKey::QUIC_SENT].info.color = colors[current_color];
+        (*exp)[StatKey::BITRATE].info.color = colors[current_color];
 
-        add_serie(p.c_str(), StatKey::QUIC_SENT);
+        ++current_color;
+        current_color = current_color % colors.size();
 
-        _infos_array[StatKey::QUIC_SENT].mean /= sum;
-        _infos_array[StatKey::QUIC_SENT].variance = (_infos_array[StatKey::QUIC_SENT].variance / sum) - ( _infos_array[StatKey::QUIC_SENT].mean *  _infos_array[StatKey::QUIC_SENT].mean);
+        // (*exp)[StatKey::BITRATE].name = p.c_str();
 
-        QTreeWidgetItem * quic_mean = new QTreeWidgetItem(item);
-        quic_mean->setText(0, "QUIC sent mean");
-        quic_mean->setText(1, QString::number(_infos_array[StatKey::QUIC_SENT].mean));
+        attach_points(exp, staged);
 
-        QTreeWidgetItem * quic_variance = new QTreeWidgetItem(item);
-        quic_variance->setText(0, "QUIC sent variance");
-        quic_variance->setText(1, QString::number(_infos_array[StatKey::QUIC_SENT].variance));
-    }
+        if(first) add_serie(exp, StatKey::LINK);
+        add_serie(exp, StatKey::BITRATE);
+        add_serie(exp, StatKey::FPS);
+
+        QTreeWidgetItem * item = new QTreeWidgetItem(_info);
+        item->setText(0, path.parent_path().filename().c_str());
+
+        QTreeWidgetItem * bitrate_mean = new QTreeWidgetItem(item);
+        bitrate_mean->setText(0, "RTC Bitrate mean");
+        bitrate_mean->setText(1, QString::number(bitrate_stats.mean()));
+
+        QTreeWidgetItem * bitrate_variance = new QTreeWidgetItem(item);
+        bitrate_variance->setText(0, "RTC Bitrate variance");
+        bitrate_variance->setText(1, QString::number(bitrate_stats.variance()));
+
+        add_percentiles(item, "RTC Bitrate", bitrate_stats.percentiles());
+
+        QTreeWidgetItem * fps_mean = new QTreeWidgetItem(item);
+        fps_mean->setText(0, "FPS mean");
+        fps_mean->setText(1, QString::number(fps_stats.mean()));
+
+        QTreeWidgetItem * fps_variance= new QTreeWidgetItem(item);
+        fps_variance->setText(0, "FPS variance");
+        fps_variance->setText(1, QString::number(fps_stats.variance()));
+
+        if(has_quic) {
+            add_serie(exp, StatKey::QUIC_SENT);
+
+            QTreeWidgetItem * quic_mean = new QTreeWidgetItem(item);
+            quic_mean->setText(0, "QUIC sent mean");
+            quic_mean->setText(1, QString::number(quic_stats.mean()));
+
+            QTreeWidgetItem * quic_variance = new QTreeWidgetItem(item);
+            quic_variance->setText(0, "QUIC sent variance");
+            quic_variance->setText(1, QString::number(quic_stats.variance()));
+
+            add_percentiles(item, "QUIC sent", quic_stats.percentiles());
+        }
+    };
 }
 
 template<typename T>
-bool ReceivedBitrateDisplay::get_stats(const fs::path& p, std::ifstream& ifs, std::vector<StatLinePoint<T>>& tab, StatKey key)
+bool ReceivedBitrateDisplay::get_stats(Staged& staged, std::istream& ifs, std::vector<StatLinePoint>& tab, StatKey key)
 {
-    tab.emplace_back(StatLinePoint<T>{});
-    if(!get_csv_line(ifs, tab)) {
+    tab.emplace_back(StatLinePoint{});
+    if(!get_csv_line<T>(ifs, tab)) {
         tab.pop_back();
         return false;
     }
 
-    StatKey key_box, key_inter;
-    switch(key) {
-    case StatKey::BITRATE:
-        key_box = StatKey::BITRATE_BOX;
-        key_inter= StatKey::BITRATE_INTERQUARTILE;
-        break;
-    case StatKey::FPS:
-        key_box = StatKey::FPS_BOX;
-        key_inter = StatKey::FPS_INTERQUARTILE;
-        break;
-    case StatKey::LINK: {
-        QPoint pt{(int)tab.back().time, tab.back().values.front()};
-        add_point(p.c_str(), key, pt);
+    if(key == StatKey::LINK) {
+        if(tab.back().stats.count == 0) return true;
+
+        QPoint pt{(int)tab.back().time, (int)tab.back().stats.min};
+        staged.add_point(key, pt);
         return true;
     }
-    default:
-        return false;
-    }
 
-    QPointF avg{(double)tab.back().time, get_average(tab.back().values)};
-    QPointF inter{(double)tab.back().time, get_interquartile_average(tab.back().values)};
+    if(key != StatKey::BITRATE && key != StatKey::FPS) return false;
 
-    add_point(p.c_str(), key, avg);
-    add_point(p.c_str(), key_inter, inter);
-    add_point(p.c_str(), key_box, QString::number(tab.back().time), tab.back().values);
+    QPointF avg{(double)tab.back().time, tab.back().stats.mean};
+    staged.add_point(key, avg);
 
     return true;
 }
 
-void ReceivedBitrateDisplay::load_stat_line(const fs::path& p)
+DisplayBase::Attach ReceivedBitrateDisplay::parse_stat_line(const fs::path& p, std::stop_token stop)
 {
-    fs::path file = p / "bitrate_line.csv";
+    fs::path file = find_input(p / "bitrate_line.csv");
 
-    std::ifstream ifs(file.c_str());
+    InputStream ifs(file);
     if(!ifs.is_open()) {
         throw std::runtime_error("Could not open csv file with provided path : " + file.string());
     }
 
-    // to have link only one time
-    // == 1 becasue there should already be legend hence not empty
-    if(_path_keys.size() == 1) create_serie(p, StatKey::LINK);
+    Staged staged;
 
-    create_serie(p, StatKey::BITRATE);
-    create_serie(p, StatKey::BITRATE_INTERQUARTILE);
-    create_serie<QBoxPlotSeries>(p, StatKey::BITRATE_BOX);
+    std::vector<StatLinePoint> bitrate;
+    std::vector<StatLinePoint> fps;
+    std::vector<StatLinePoint> link;
 
-    create_serie(p, StatKey::FPS);
-    create_serie(p, StatKey::FPS_INTERQUARTILE);
-    create_serie<QBoxPlotSeries>(p, StatKey::FPS_BOX);
+    while(!ifs.eof()) {
+        if(stop.stop_requested()) return {};
 
-    // set_makeup(p);
+        if(!get_stats<int>(staged, ifs, link, StatKey::LINK)) break;
+        get_stats<int>(staged, ifs, bitrate, StatKey::BITRATE);
+        get_stats<int>(staged, ifs, fps, StatKey::FPS);
+    }
 
-    std::vector<StatLinePoint<int>> bitrate;
-    std::vector<StatLinePoint<int>> fps;
-    std::vector<StatLinePoint<int>> link;
+    staged.index();
 
-    while(!ifs.eof()) {
-        if(!get_stats(p, ifs, link, StatKey::LINK)) break;
-        get_stats(p, ifs, bitrate, StatKey::BITRATE);
-        get_stats(p, ifs, fps, StatKey::FPS);
-    }
+    // the interquartile means and boxes are only computed when shown
+    return [this, p, staged = std::move(staged), bitrate = share_rows(std::move(bitrate)), fps = share_rows(std::move(fps))]() {
+        // to have link only one time
+        bool first = _experiments.empty();
+        auto exp = experiment(p);
+
+        if(first) create_serie(exp, StatKey::LINK);
 
-    add_serie(p.c_str(), StatKey::LINK);
-    add_serie(p.c_str(), StatKey::BITRATE);
-    add_serie(p.c_str(), StatKey::BITRATE_INTERQUARTILE);
-    add_serie(p.c_str(), StatKey::FPS);
-    add_serie(p.c_str(), StatKey::FPS_INTERQUARTILE);
-    // add_serie<QBoxPlotSeries>(p.c_str(), StatKey::BITRATE_BOX);
-    // add_serie<QBoxPlotSeries>(p.c_str(), StatKey::FPS_BOX);
+        create_serie(exp, StatKey::BITRATE);
+        create_serie(exp, StatKey::FPS);
+
+        // set_makeup(p);
+
+        attach_points(exp, staged);
+
+        add_serie(exp, StatKey::LINK);
+        add_serie(exp, StatKey::BITRATE);
+        add_serie(exp, StatKey::FPS);
+
+        defer_stat_line(exp, bitrate, StatKey::BITRATE_INTERQUARTILE, StatKey::BITRATE_BOX);
+        defer_stat_line(exp, fps, StatKey::FPS_INTERQUARTILE, StatKey::FPS_BOX);
+    };
 }
 
 // bitrate.csv : time, bitrate, link, fps, frame_dropped, frame_decoded, frame_keydecoded, frame_rendered
 // quic.csv : time, bitrate
-void ReceivedBitrateDisplay::load(const fs::path& p)
+DisplayBase::Attach ReceivedBitrateDisplay::parse(const fs::path& p, const ExperimentCatalog* catalog, std::stop_token stop)
 {
-    if(p.filename().string() == "average") load_stat_line(p);
-    else load_exp(p);
+    if(stop.stop_requested()) return {};
 
-    _chart_bitrate->createDefaultAxes();
-    _chart_fps->createDefaultAxes();
+    Attach attach;
+    if(p.filename().string() == "average") attach = parse_stat_line(p, stop);
+    else attach = parse_exp(p, stop);
+
+    if(!attach) return {};
+
+    return [this, p, attach = std::move(attach)]() {
+        attach();
+        set_makeup(p);
+        update_charts();
 
-    set_makeup(p);
+        // _chart_view_fps->hide();
+        // _chart_view_bitrate->setGeometry(0,0,1,1);
+    };
+}
 
-    // _chart_view_fps->hide();
-    // _chart_view_bitrate->setGeometry(0,0,1,1);
+void ReceivedBitrateDisplay::load(const fs::path& p)
+{
+    if(auto attach = parse(p, _catalog.get())) attach();
 }
 
 void ReceivedBitrateDisplay::save(const fs::path& dir)
@@ -350,10 +392,12 @@ void ReceivedBitrateDisplay::save(const fs::path& dir)
 
 void ReceivedBitrateDisplay::add_to_all(const fs::path& dir, AllBitrateDisplay* all)
 {
-    auto& map = _path_keys[dir.c_str()];
-    // all->add_stats(dir, AllBitrateDisplay::LINK, map[LINK]);
-    // all->add_stats(dir, AllBitrateDisplay::BITRATE, map[BITRATE]);
-    // all->add_stats(dir, AllBitrateDisplay::QUIC_SENT, map[QUIC_SENT]);
+    auto exp = find_experiment(dir);
+    if(!exp) return;
+
+    // all->add_stats(dir, AllBitrateDisplay::LINK, (*exp)[LINK]);
+    // all->add_stats(dir, AllBitrateDisplay::BITRATE, (*exp)[BITRATE]);
+    // all->add_stats(dir, AllBitrateDisplay::QUIC_SENT, (*exp)[QUIC_SENT]);
 }
 
 void ReceivedBitrateDisplay::set_geometry(float ratio_w, float ratio_h)
@@ -57,28 +57,24 @@ class ReceivedBitrateDisplay : public QObject, public DisplayBase
         NUM_KEY
     };
 
-    struct Info
-    {
-        double mean = 0.;
-        double variance = 0.;
-    };
+    static_assert(StatKey::NUM_KEY <= MAX_KEYS);
 
     StatsLineChart * _chart_bitrate, * _chart_fps;
     StatsLineChartView* _chart_view_bitrate, * _chart_view_fps;
-    std::array<Info, StatKey::NUM_KEY> _infos_array;
 
     static std::vector<QColor> colors;
     int current_color = 0;
 
-    void init_map(StatMap& map, bool signal = true) override;
+    void init_map(Experiment& exp) override;
+    void refresh_charts() override;
 
-    void load_exp(const fs::path& p);
-    void load_stat_line(const fs::path& p);
+    Attach parse_exp(const fs::path& p, std::stop_token stop);
+    Attach parse_stat_line(const fs::path& p, std::stop_token stop);
 
-    void set_makeup(const fs::path& p);
+    void set_makeup(const fs::path& p) override;
 
     template<typename T>
-    bool get_stats(const fs::path& p, std::ifstream& ifs, std::vector<StatLinePoint<T>>& tab, StatKey key);
+    static bool get_stats(Staged& staged, std::istream& ifs, std::vector<StatLinePoint>& tab, StatKey key);
 public:
     ReceivedBitrateDisplay(QWidget* tab, QVBoxLayout* layout, QListWidget* legend, QTreeWidget* info_widget);
     ~ReceivedBitrateDisplay() = default;
@@ -87,6 +83,11 @@ public:
 
     // load bitrate.csv, quic.csv
     void load(const fs::path& path) override;
+    Attach parse(const fs::path& path, const ExperimentCatalog* catalog, std::stop_token stop = {}) override;
+
+    // Parse the result files of experiment p into their column cache,
+    // without touching any widget. Safe to call from any thread.
+    static void warm_cache(const fs::path& p);
 
     void save(const fs::path& dir) override;
     void on_keyboard_event(QKeyEvent * event);
@@ -0,0 +1,103 @@
+#ifndef ROW_STATS_H
+#define ROW_STATS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <span>
+
+// Summary of the values of one row of a stat line file, the runs of an
+// experiment at one instant. The quartiles are the medians of the lower
+// and upper halves, the middle value excluded when the count is odd.
+struct RowStats
+{
+    static constexpr double NONE = std::numeric_limits<double>::quiet_NaN();
+
+    size_t count = 0;
+
+    double min = NONE;
+    double lower_quartile = NONE;
+    double median = NONE;
+    double upper_quartile = NONE;
+    double max = NONE;
+
+    double mean = NONE;
+    double interquartile_mean = NONE;  // of the values within the quartiles
+
+    void scale(double factor)
+    {
+        for(double* v : { &min, &lower_quartile, &median, &upper_quartile, &max, &mean, &interquartile_mean }) {
+            *v *= factor;
+        }
+    }
+};
+
+// Selects the ranks the quartiles need instead of sorting the row, so the
+// cost is linear in its size. values are reordered.
+template<typename T>
+RowStats row_stats(std::span<T> values)
+{
+    RowStats stats;
+    stats.count = values.size();
+
+    if(values.empty()) return stats;
+
+    T min = values[0], max = values[0];
+    double sum = 0.;
+
+    for(T v : values) {
+        min = std::min(min, v);
+        max = std::max(max, v);
+        sum += v;
+    }
+
+    stats.min = min;
+    stats.max = max;
+    stats.mean = sum / values.size();
+
+    // ranks are asked in increasing order, each one is selected among the
+    // values right of the previous one
+    size_t selected = 0;
+    auto at = [&values, &selected](size_t rank) -> double {
+        if(rank >= selected) {
+            std::nth_element(values.begin() + selected, values.begin() + rank, values.end());
+            selected = rank + 1;
+        }
+
+        return values[rank];
+    };
+
+    auto median_of = [&at](size_t begin, size_t end) {
+        size_t n = end - begin;
+        return (n % 2) ? at(begin + n / 2) : (at(begin + n / 2 - 1) + at(begin + n / 2)) / 2.;
+    };
+
+    size_t count = values.size();
+    size_t half = count / 2;
+
+    if(half == 0) {
+        stats.lower_quartile = stats.median = stats.upper_quartile = values[0];
+        stats.interquartile_mean = values[0];
+        return stats;
+    }
+
+    stats.lower_quartile = median_of(0, half);
+    stats.median = median_of(0, count);
+    stats.upper_quartile = median_of(half + count % 2, count);
+
+    double inner_sum = 0.;
+    size_t inner = 0;
+
+    for(T v : values) {
+        bool within = (v >= stats.lower_quartile && v <= stats.upper_quartile);
+        inner_sum += within ? v : 0;
+        inner += within;
+    }
+
+    stats.interquartile_mean = inner_sum / inner;
+
+    return stats;
+}
+
+#endif // ROW_STATS_H
@@ -0,0 +1,63 @@
+#ifndef RUNNING_STATS_H
+#define RUNNING_STATS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+// Count, mean, variance and extrema of a stream of values, updated with
+// Welford's method so that the variance of large values does not cancel
+// out. Accumulators of parts of the values merge into the one of the
+// whole (Chan et al.), in any order.
+class RunningStats
+{
+    static constexpr double NONE = std::numeric_limits<double>::quiet_NaN();
+
+    uint64_t _count = 0;
+    double _mean = 0.;
+    double _m2 = 0.;  // sum of the squared differences to the mean
+    double _min = std::numeric_limits<double>::infinity();
+    double _max = -std::numeric_limits<double>::infinity();
+
+public:
+    void add(double value)
+    {
+        ++_count;
+
+        double delta = value - _mean;
+        _mean += delta / _count;
+        _m2 += delta * (value - _mean);
+
+        _min = std::min(_min, value);
+        _max = std::max(_max, value);
+    }
+
+    void merge(const RunningStats& other)
+    {
+        if(other._count == 0) return;
+        if(_count == 0) {
+            *this = other;
+            return;
+        }
+
+        uint64_t count = _count + other._count;
+        double delta = other._mean - _mean;
+
+        _mean += delta * other._count / count;
+        _m2 += other._m2 + delta * delta * (static_cast<double>(_count) * other._count / count);
+        _count = count;
+
+        _min = std::min(_min, other._min);
+        _max = std::max(_max, other._max);
+    }
+
+    uint64_t count() const { return _count; }
+
+    // NaN without values
+    double mean() const { return _count ? _mean : NONE; }
+    double variance() const { return _count ? _m2 / _count : NONE; }  // of the population
+    double min() const { return _count ? _min : NONE; }
+    double max() const { return _count ? _max : NONE; }
+};
+
+#endif // RUNNING_STATS_H
@@ -0,0 +1,63 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(size_t threads)
+{
+    if(threads == 0) threads = 1;
+
+    _workers.reserve(threads);
+    for(size_t i = 0; i < threads; ++i) {
+        _workers.emplace_back([this]() { worker(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _stop = true;
+    }
+
+    _cv.notify_all();
+    _workers.clear();
+}
+
+void ThreadPool::worker()
+{
+    while(true) {
+        std::move_only_function<void()> task;
+
+        {
+            std::unique_lock lock(_mutex);
+            _cv.wait(lock, [this]() { return _stop || !_tasks.empty(); });
+
+            if(_stop && _tasks.empty()) return;
+
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+
+        task();
+    }
+}
+
+bool ThreadPool::try_run_one()
+{
+    std::move_only_function<void()> task;
+
+    {
+        std::lock_guard lock(_mutex);
+        if(_tasks.empty()) return false;
+
+        task = std::move(_tasks.front());
+        _tasks.pop_front();
+    }
+
+    task();
+    return true;
+}
+
+ThreadPool& ThreadPool::global()
+{
+    static ThreadPool pool;
+    return pool;
+}
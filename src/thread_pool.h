@@ -0,0 +1,69 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed size pool of worker threads consuming a FIFO of tasks.
+//
+// Tasks may themselves submit work and wait on it : wait() runs queued
+// tasks on the calling thread while the futures are not ready, so nested
+// parallelism never starves the pool.
+class ThreadPool
+{
+    std::vector<std::jthread> _workers;
+    std::deque<std::move_only_function<void()>> _tasks;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _stop = false;
+
+    void worker();
+
+public:
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return _workers.size(); }
+
+    template<typename F>
+    auto submit(F&& f) -> std::future<std::invoke_result_t<F>>
+    {
+        std::packaged_task<std::invoke_result_t<F>()> task(std::forward<F>(f));
+        auto future = task.get_future();
+
+        {
+            std::lock_guard lock(_mutex);
+            _tasks.emplace_back(std::move(task));
+        }
+
+        _cv.notify_one();
+        return future;
+    }
+
+    // Run one queued task on the calling thread, false if the queue is empty
+    bool try_run_one();
+
+    template<typename T>
+    void wait(std::vector<std::future<T>>& futures)
+    {
+        for(auto& f : futures) {
+            while(f.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                // nothing left to help with, the remaining tasks are running
+                if(!try_run_one()) f.wait();
+            }
+        }
+    }
+
+    // Shared pool sized on the number of cores
+    static ThreadPool& global();
+};
+
+#endif // THREAD_POOL_H